@@ -1,14 +1,39 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
+import esphome.final_validate as fv
+from esphome.helpers import cpp_string_escape
 
 from esphome.const import (
+    CONF_ACCURACY_DECIMALS,
+    CONF_FORMAT,
+    CONF_FREQUENCY,
     CONF_ID,
+    CONF_PORT,
+    CONF_SENSOR,
     CONF_MAC_ADDRESS,
+    CONF_TIME_ID,
+    CONF_TRIGGER_ID,
+    CONF_UPDATE_INTERVAL,
+    CONF_USERNAME,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    UNIT_MILLISECOND,
+    UNIT_SECOND,
 )
 
+from esphome.components import binary_sensor as binary_sensor_comp
+from esphome.components.esp32 import add_idf_sdkconfig_option
 from esphome.components import sensor as sensor_comp
+from esphome.components import text_sensor as text_sensor_comp
+from esphome.components import time as time_comp
 
 DEPENDENCIES = ["esp32"]
+AUTO_LOAD = ["socket"]
+# Up to 4 radios per node (XRSRadioComponent::MAX_RADIOS); they share one
+# Bluetooth stack and take turns connecting.
+MULTI_CONF = True
 
 xrs_radio_ns = cg.esphome_ns.namespace("xrs_radio")
 
@@ -18,13 +43,303 @@ XRSTextSensorType = xrs_radio_ns.enum("XRSTextSensorType")
 XRSNumberType = xrs_radio_ns.enum("XRSNumberType")
 XRSSwitchType = xrs_radio_ns.enum("XRSSwitchType")
 XRSSelectType = xrs_radio_ns.enum("XRSSelectType")
+XRSMetricType = xrs_radio_ns.enum("XRSMetricType")
 
 XRSRadioComponent = xrs_radio_ns.class_("XRSRadioComponent", cg.Component)
 
+ExportEventsAction = xrs_radio_ns.class_("ExportEventsAction", automation.Action)
+TuneFrequencyAction = xrs_radio_ns.class_("TuneFrequencyAction", automation.Action)
+ExportChannelTableAction = xrs_radio_ns.class_("ExportChannelTableAction", automation.Action)
+XRSTableExportFormat = xrs_radio_ns.enum("XRSTableExportFormat")
+ChannelTableChangeTrigger = xrs_radio_ns.class_(
+    "ChannelTableChangeTrigger", automation.Trigger.template(cg.uint32)
+)
+XRSFrequencyBand = xrs_radio_ns.enum("XRSFrequencyBand")
+LineMatcher = xrs_radio_ns.class_("LineMatcher")
+LineTrigger = xrs_radio_ns.class_(
+    "LineTrigger",
+    automation.Trigger.template(cg.std_string, cg.std_vector.template(cg.std_string)),
+)
+
 CONF_XRS_ID = "xrs_id"
 CONF_LATITUDE_SENSOR = "latitude_sensor"
 CONF_LONGITUDE_SENSOR = "longitude_sensor"
 CONF_LOCATION_INTERVAL = "location_interval"
+CONF_LOCATION_MIN_INTERVAL = "location_min_interval"
+CONF_LOCATION_MAX_INTERVAL = "location_max_interval"
+CONF_LOCATION_MIN_DISTANCE = "location_min_distance"
+CONF_LOCATION_HEADING_CHANGE = "location_heading_change"
+CONF_LOCATION_MAX_SPEED = "location_max_speed"
+CONF_LOCATION_SMOOTHING = "location_smoothing"
+CONF_METRICS = "metrics"
+CONF_AIRTIME_UPDATE_INTERVAL = "airtime_update_interval"
+CONF_RANK = "rank"
+CONF_EVENT_HISTORY_SIZE = "event_history_size"
+CONF_MAX_EVENTS = "max_events"
+CONF_CHANGE_TIMEOUT = "change_timeout"
+CONF_BAND = "band"
+CONF_AT_BRIDGE = "at_bridge"
+CONF_MAX_CLIENTS = "max_clients"
+CONF_BUFFER_SIZE = "buffer_size"
+CONF_ON_CHANNEL_TABLE_CHANGE = "on_channel_table_change"
+CONF_TOLERANCE = "tolerance"
+CONF_ON_LINE = "on_line"
+CONF_PATTERN = "pattern"
+CONF_STATUS_MESSAGE = "status_message"
+CONF_STATUS = "status"
+CONF_INPUTS = "inputs"
+CONF_TEXT_SENSOR = "text_sensor"
+CONF_MIN_INTERVAL = "min_interval"
+CONF_BURST = "burst"
+CONF_ACTIVE_MUTE = "active_mute"
+CONF_CALL_SENSOR = "call_sensor"
+CONF_KEEPALIVE_INTERVAL = "keepalive_interval"
+CONF_LEVEL_PREFIX = "level_prefix"
+CONF_ECHO = "echo"
+CONF_LEVEL_HYSTERESIS = "level_hysteresis"
+CONF_BLUETOOTH = "bluetooth"
+CONF_CLASSIC_ONLY = "classic_only"
+CONF_RELEASE_BLE_MEMORY = "release_ble_memory"
+CONF_START_AFTER_NETWORK = "start_after_network"
+CONF_NETWORK_TIMEOUT = "network_timeout"
+CONF_START_DELAY = "start_delay"
+CONF_NO_HEAP = "no_heap"
+CONF_RX_BUFFER_SIZE = "rx_buffer_size"
+CONF_MAX_LINE_LENGTH = "max_line_length"
+CONF_TX_QUEUE_SIZE = "tx_queue_size"
+CONF_MAX_COMMAND_LENGTH = "max_command_length"
+CONF_CHANNEL_TABLE_SIZE = "channel_table_size"
+CONF_CHECK_ALLOCATIONS = "check_allocations"
+
+XRS_TABLE_EXPORT_FORMATS = {
+    "csv": XRSTableExportFormat.XRS_TABLE_EXPORT_CSV,
+    "json": XRSTableExportFormat.XRS_TABLE_EXPORT_JSON,
+}
+
+XRS_FREQUENCY_BANDS = {
+    "rx": XRSFrequencyBand.XRS_FREQ_RX,
+    "tx": XRSFrequencyBand.XRS_FREQ_TX,
+}
+
+# Matches LineMatcher::MAX_FIELDS / NONE on the C++ side.
+LINE_MATCHER_MAX_FIELDS = 8
+LINE_MATCHER_NONE = 0xFFFF
+
+
+def validate_line_pattern(value):
+    value = cv.string_strict(value)
+    if not value:
+        raise cv.Invalid("Line pattern must not be empty")
+    if len(value) > 255:
+        raise cv.Invalid("Line pattern must be at most 255 characters")
+    if value.count("*") > LINE_MATCHER_MAX_FIELDS:
+        raise cv.Invalid(f"Line pattern may have at most {LINE_MATCHER_MAX_FIELDS} '*' fields")
+    return value
+
+
+def _literal_prefix(pattern):
+    for i, ch in enumerate(pattern):
+        if ch in "*?":
+            return pattern[:i]
+    return pattern
+
+
+def _compile_line_patterns(patterns):
+    """Merge the literal prefixes of all patterns into one trie, flattened
+    breadth-first so every node's children are consecutive (LineMatcher::Node)."""
+    root = {"children": {}, "terms": []}
+    for index, pattern in enumerate(patterns):
+        node = root
+        for ch in _literal_prefix(pattern).encode("utf-8"):
+            node = node["children"].setdefault(ch, {"children": {}, "terms": []})
+        node["terms"].append(index)
+
+    entries = [(0, root)]
+    nodes = []
+    terms = []
+    i = 0
+    while i < len(entries):
+        ch, node = entries[i]
+        children = sorted(node["children"].items())
+        first_child = len(entries) if children else LINE_MATCHER_NONE
+        entries.extend(children)
+        nodes.append((ch, first_child, len(children), len(terms), len(node["terms"])))
+        terms.extend(node["terms"])
+        i += 1
+    return nodes, terms
+
+
+def _split_status_template(value):
+    """Split a status template on "{}" slots ("{{" / "}}" are literal braces)."""
+    literals = [""]
+    i = 0
+    while i < len(value):
+        if value.startswith("{{", i) or value.startswith("}}", i):
+            literals[-1] += value[i]
+            i += 2
+        elif value.startswith("{}", i):
+            literals.append("")
+            i += 2
+        elif value[i] in "{}":
+            raise cv.Invalid("Use {} for an input, {{ and }} for literal braces")
+        else:
+            literals[-1] += value[i]
+            i += 1
+    return literals
+
+
+def validate_status_message(config):
+    for key in (CONF_USERNAME, CONF_STATUS):
+        if '"' in config[key]:
+            raise cv.Invalid(f"{key} must not contain double quotes")
+    if "#" in config[CONF_USERNAME]:
+        raise cv.Invalid("username must not contain '#'")
+    slots = len(_split_status_template(config[CONF_STATUS])) - 1
+    if slots != len(config[CONF_INPUTS]):
+        raise cv.Invalid(f"status has {slots} {{}} slots but {len(config[CONF_INPUTS])} inputs are configured")
+    return config
+
+
+STATUS_INPUT_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Exclusive(CONF_SENSOR, "input"): cv.use_id(sensor_comp.Sensor),
+            cv.Exclusive(CONF_TEXT_SENSOR, "input"): cv.use_id(text_sensor_comp.TextSensor),
+            cv.Optional(CONF_ACCURACY_DECIMALS, default=0): cv.int_range(min=0, max=6),
+        }
+    ),
+    cv.has_exactly_one_key(CONF_SENSOR, CONF_TEXT_SENSOR),
+)
+
+STATUS_MESSAGE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Required(CONF_USERNAME): cv.string_strict,
+            # Status text; each {} is replaced by the matching input's state
+            cv.Required(CONF_STATUS): cv.string_strict,
+            cv.Optional(CONF_INPUTS, default=[]): cv.ensure_list(STATUS_INPUT_SCHEMA),
+            # Token bucket: `burst` messages back to back, then one per
+            # min_interval while inputs keep changing
+            cv.Optional(CONF_MIN_INTERVAL, default="30s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_BURST, default=2): cv.int_range(min=1, max=10),
+        }
+    ),
+    validate_status_message,
+)
+
+# Matches AirtimeTracker::CAPACITY on the C++ side.
+AIRTIME_CHANNELS = 16
+AIRTIME_RANK_SCHEMA = cv.int_range(min=1, max=AIRTIME_CHANNELS)
+
+UNIT_BYTES_PER_SECOND = "B/s"
+UNIT_LINES_PER_SECOND = "lines/s"
+UNIT_PUBLISHES_PER_SECOND = "publishes/s"
+UNIT_MICROSECOND = "µs"
+UNIT_BYTES = "B"
+
+
+def _metric_schema(unit, accuracy, state_class=STATE_CLASS_MEASUREMENT, icon=None):
+    kwargs = {
+        "accuracy_decimals": accuracy,
+        "state_class": state_class,
+        "entity_category": ENTITY_CATEGORY_DIAGNOSTIC,
+    }
+    if unit is not None:
+        kwargs["unit_of_measurement"] = unit
+    if icon is not None:
+        kwargs["icon"] = icon
+    return sensor_comp.sensor_schema(**kwargs)
+
+
+# YAML key -> (C++ enum, sensor schema) for the optional "metrics:" block.
+XRS_RADIO_METRICS = {
+    "rx_bytes_rate": (
+        XRSMetricType.XRS_METRIC_RX_BYTES_RATE,
+        _metric_schema(UNIT_BYTES_PER_SECOND, 1, icon="mdi:download-network"),
+    ),
+    "lines_rate": (
+        XRSMetricType.XRS_METRIC_LINES_RATE,
+        _metric_schema(UNIT_LINES_PER_SECOND, 2),
+    ),
+    "parse_time_p50": (
+        XRSMetricType.XRS_METRIC_PARSE_TIME_P50,
+        _metric_schema(UNIT_MICROSECOND, 0, icon="mdi:timer-outline"),
+    ),
+    "parse_time_p99": (
+        XRSMetricType.XRS_METRIC_PARSE_TIME_P99,
+        _metric_schema(UNIT_MICROSECOND, 0, icon="mdi:timer-outline"),
+    ),
+    "tx_queue_depth": (
+        XRSMetricType.XRS_METRIC_TX_QUEUE_DEPTH,
+        _metric_schema(None, 0, icon="mdi:tray-full"),
+    ),
+    "command_rtt": (
+        XRSMetricType.XRS_METRIC_COMMAND_RTT,
+        _metric_schema(UNIT_MILLISECOND, 1, icon="mdi:timer-sync-outline"),
+    ),
+    "publish_rate": (
+        XRSMetricType.XRS_METRIC_PUBLISH_RATE,
+        _metric_schema(UNIT_PUBLISHES_PER_SECOND, 2),
+    ),
+    "reconnect_count": (
+        XRSMetricType.XRS_METRIC_RECONNECT_COUNT,
+        _metric_schema(None, 0, STATE_CLASS_TOTAL_INCREASING, icon="mdi:connection"),
+    ),
+    "time_since_last_rx": (
+        XRSMetricType.XRS_METRIC_TIME_SINCE_LAST_RX,
+        _metric_schema(UNIT_SECOND, 0, icon="mdi:clock-outline"),
+    ),
+    "channel_table_heap": (
+        XRSMetricType.XRS_METRIC_CHANNEL_TABLE_HEAP,
+        _metric_schema(UNIT_BYTES, 0, icon="mdi:memory"),
+    ),
+    # Write -> echo time; only with echo enabled
+    "echo_latency": (
+        XRSMetricType.XRS_METRIC_ECHO_LATENCY,
+        _metric_schema(UNIT_MILLISECOND, 1, icon="mdi:timer-sync-outline"),
+    ),
+    # Lines dropped by the framer: cut short by a new message, or too long
+    "rx_resyncs": (
+        XRSMetricType.XRS_METRIC_RX_RESYNCS,
+        _metric_schema(None, 0, STATE_CLASS_TOTAL_INCREASING, icon="mdi:sync-alert"),
+    ),
+    "rx_overflows": (
+        XRSMetricType.XRS_METRIC_RX_OVERFLOWS,
+        _metric_schema(None, 0, STATE_CLASS_TOTAL_INCREASING, icon="mdi:text-box-remove-outline"),
+    ),
+    # Connect -> ready time of the last bring-up
+    "time_to_ready": (
+        XRSMetricType.XRS_METRIC_TIME_TO_READY,
+        _metric_schema(UNIT_MILLISECOND, 0, icon="mdi:timer-check-outline"),
+    ),
+}
+
+METRICS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+        **{cv.Optional(key): schema for key, (_, schema) in XRS_RADIO_METRICS.items()},
+    }
+)
+
+
+def _validate_bluetooth(config):
+    if config[CONF_RELEASE_BLE_MEMORY] and not config[CONF_CLASSIC_ONLY]:
+        raise cv.Invalid(f"{CONF_RELEASE_BLE_MEMORY} requires {CONF_CLASSIC_ONLY}: true")
+    return config
+
+
+BLUETOOTH_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.Optional(CONF_CLASSIC_ONLY, default=False): cv.boolean,
+            cv.Optional(CONF_RELEASE_BLE_MEMORY, default=False): cv.boolean,
+            cv.Optional(CONF_START_AFTER_NETWORK, default=False): cv.boolean,
+            cv.Optional(CONF_NETWORK_TIMEOUT, default="60s"): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_START_DELAY, default="0s"): cv.positive_time_period_milliseconds,
+        }
+    ),
+    _validate_bluetooth,
+)
 
 
 CONFIG_SCHEMA = cv.Schema(
@@ -37,10 +352,126 @@ CONFIG_SCHEMA = cv.Schema(
         cv.Optional(CONF_LATITUDE_SENSOR): cv.use_id(sensor_comp.Sensor),
         cv.Optional(CONF_LONGITUDE_SENSOR): cv.use_id(sensor_comp.Sensor),
         cv.Optional(CONF_LOCATION_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+
+        # Adaptive location upload: send on movement/turns, back off when stationary
+        cv.Optional(CONF_LOCATION_MIN_INTERVAL, default="30s"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_LOCATION_MAX_INTERVAL, default="10min"): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_LOCATION_MIN_DISTANCE, default="100m"): cv.distance,
+        cv.Optional(CONF_LOCATION_HEADING_CHANGE, default=30.0): cv.float_range(min=0.0, max=180.0),
+        cv.Optional(CONF_TIME_ID): cv.use_id(time_comp.RealTimeClock),
+
+        # Fix filtering: reject jumps faster than max speed (m/s), smooth the rest
+        cv.Optional(CONF_LOCATION_MAX_SPEED, default=70.0): cv.positive_float,
+        cv.Optional(CONF_LOCATION_SMOOTHING, default=0.5): cv.float_range(min=0.05, max=1.0),
+
+        # How often busiest-channel airtime sensors are published
+        cv.Optional(CONF_AIRTIME_UPDATE_INTERVAL, default="60s"): cv.positive_time_period_milliseconds,
+
+        # Bounded ring of recent radio events (0 disables the history)
+        cv.Optional(CONF_EVENT_HISTORY_SIZE, default=64): cv.int_range(min=0, max=1024),
+
+        # Lines from the radio longer than this are dropped whole
+        cv.Optional(CONF_MAX_LINE_LENGTH, default=256): cv.int_range(min=32, max=4096),
+
+        # ATE1 (echo, used for echo_latency) or ATE0 in the handshake
+        cv.Optional(CONF_ECHO, default=True): cv.boolean,
+
+        # Roll an unconfirmed zone/channel change back after this long
+        cv.Optional(CONF_CHANGE_TIMEOUT, default="3s"): cv.positive_time_period_milliseconds,
+
+        # Optional raw AT-over-TCP bridge for local diagnostic/programming tools
+        cv.Optional(CONF_AT_BRIDGE): cv.Schema(
+            {
+                cv.Optional(CONF_PORT, default=2323): cv.port,
+                # Matches ATBridge::MAX_CLIENTS on the C++ side.
+                cv.Optional(CONF_MAX_CLIENTS, default=2): cv.int_range(min=1, max=4),
+                # Per-client output buffer; lines that don't fit are dropped.
+                cv.Optional(CONF_BUFFER_SIZE, default=1024): cv.int_range(min=256, max=8192),
+            }
+        ),
+
+        # AT+WGTMSG status message templated from sensors, sent on connect
+        # and whenever its text changes (rate limited)
+        cv.Optional(CONF_STATUS_MESSAGE): STATUS_MESSAGE_SCHEMA,
+
+        # 0-100 level report (protocol.md 5.3) and the points it must move
+        # before the level sensors republish
+        cv.Optional(CONF_LEVEL_PREFIX, default="+WGLEVEL:"): cv.string_strict,
+        cv.Optional(CONF_LEVEL_HYSTERESIS, default=3): cv.int_range(min=0, max=12),
+
+        # Mute the radio while a phone call is active (AT+WGACTM), with
+        # periodic keep-alives for as long as the call lasts
+        cv.Optional(CONF_ACTIVE_MUTE): cv.Schema(
+            {
+                cv.Required(CONF_CALL_SENSOR): cv.use_id(binary_sensor_comp.BinarySensor),
+                cv.Optional(CONF_KEEPALIVE_INTERVAL, default="5s"): cv.All(
+                    cv.positive_time_period_milliseconds,
+                    cv.Range(min=cv.TimePeriod(milliseconds=500)),
+                ),
+            }
+        ),
+
+        # Fires (with the new table hash) only when a table load really
+        # added, changed or removed channels
+        cv.Optional(CONF_ON_CHANNEL_TABLE_CHANGE): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(ChannelTableChangeTrigger),
+            }
+        ),
+
+        # Automations on raw radio lines matching a glob ('*' = field,
+        # '?' = any one character), e.g. "+WGALERT:*"
+        cv.Optional(CONF_ON_LINE): automation.validate_automation(
+            {
+                cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(LineTrigger),
+                cv.Required(CONF_PATTERN): validate_line_pattern,
+            }
+        ),
+
+        # Allocate every buffer once in setup() at these sizes and never grow
+        # them afterwards; data that does not fit is dropped and logged
+        cv.Optional(CONF_NO_HEAP): cv.Schema(
+            {
+                cv.Optional(CONF_RX_BUFFER_SIZE, default=1024): cv.int_range(min=128, max=16384),
+                cv.Optional(CONF_TX_QUEUE_SIZE, default=16): cv.int_range(min=4, max=64),
+                cv.Optional(CONF_MAX_COMMAND_LENGTH, default=128): cv.int_range(min=32, max=1024),
+                cv.Optional(CONF_CHANNEL_TABLE_SIZE, default=256): cv.int_range(min=1, max=2048),
+                # Count heap allocations in the steady state through the
+                # ESP-IDF heap hooks and mark the hub failed on any
+                cv.Optional(CONF_CHECK_ALLOCATIONS, default=True): cv.boolean,
+            }
+        ),
+
+        # Controller mode, BLE memory and when the shared Bluetooth stack
+        # is brought up; must be the same for every radio on the node
+        cv.Optional(CONF_BLUETOOTH, default={}): BLUETOOTH_SCHEMA,
+
+        # Optional runtime metrics published as diagnostic sensors
+        cv.Optional(CONF_METRICS): METRICS_SCHEMA,
     }
 ).extend(cv.COMPONENT_SCHEMA)
 
 
+def _final_validate(config):
+    full_config = fv.full_config.get()
+    bt = config[CONF_BLUETOOTH]
+    for other in full_config.get("xrs_radio", []):
+        if other[CONF_BLUETOOTH] != bt:
+            raise cv.Invalid(
+                f"All xrs_radio entries share one Bluetooth stack and must use the same {CONF_BLUETOOTH} settings"
+            )
+    if bt[CONF_RELEASE_BLE_MEMORY]:
+        for ble in ("esp32_ble", "esp32_ble_tracker", "esp32_ble_server"):
+            if ble in full_config:
+                raise cv.Invalid(f"{CONF_RELEASE_BLE_MEMORY} cannot be used together with {ble}")
+    if bt[CONF_START_AFTER_NETWORK] and "wifi" not in full_config and "ethernet" not in full_config:
+        raise cv.Invalid(f"{CONF_START_AFTER_NETWORK} needs wifi or ethernet")
+    return config
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
@@ -57,5 +488,193 @@ async def to_code(config):
         lon = await cg.get_variable(lon_id)
         cg.add(var.set_location_sensors(lat, lon))
 
-    # --- Location update interval ---
+    # --- Location update interval and movement gating ---
     cg.add(var.set_location_interval(config[CONF_LOCATION_INTERVAL]))
+    cg.add(var.set_location_min_interval(config[CONF_LOCATION_MIN_INTERVAL]))
+    cg.add(var.set_location_max_interval(config[CONF_LOCATION_MAX_INTERVAL]))
+    cg.add(var.set_location_min_distance(config[CONF_LOCATION_MIN_DISTANCE]))
+    cg.add(var.set_location_heading_change(config[CONF_LOCATION_HEADING_CHANGE]))
+    cg.add(var.set_location_max_speed(config[CONF_LOCATION_MAX_SPEED]))
+    cg.add(var.set_location_smoothing(config[CONF_LOCATION_SMOOTHING]))
+
+    # --- Optional UTC time source for the AT+WGTLOC HHMMSS field ---
+    if CONF_TIME_ID in config:
+        rtc = await cg.get_variable(config[CONF_TIME_ID])
+        cg.add(var.set_time(rtc))
+
+    # --- Per-channel airtime publishing ---
+    cg.add(var.set_airtime_update_interval(config[CONF_AIRTIME_UPDATE_INTERVAL]))
+
+    # --- Event history ---
+    cg.add(var.set_event_history_size(config[CONF_EVENT_HISTORY_SIZE]))
+
+    # --- RX framing ---
+    cg.add(var.set_max_line_length(config[CONF_MAX_LINE_LENGTH]))
+
+    # --- Command echo ---
+    cg.add(var.set_echo(config[CONF_ECHO]))
+
+    # --- Optimistic zone/channel changes ---
+    cg.add(var.set_change_timeout(config[CONF_CHANGE_TIMEOUT]))
+
+    # --- Optional AT-over-TCP bridge ---
+    if bridge := config.get(CONF_AT_BRIDGE):
+        cg.add_define("USE_XRS_AT_BRIDGE")
+        cg.add(var.set_at_bridge_port(bridge[CONF_PORT]))
+        cg.add(var.set_at_bridge_max_clients(bridge[CONF_MAX_CLIENTS]))
+        cg.add(var.set_at_bridge_buffer_size(bridge[CONF_BUFFER_SIZE]))
+
+    # --- Templated status message ---
+    if status := config.get(CONF_STATUS_MESSAGE):
+        cg.add(var.set_status_username(status[CONF_USERNAME]))
+        cg.add(var.set_status_template(_split_status_template(status[CONF_STATUS])))
+        cg.add(var.set_status_rate(status[CONF_MIN_INTERVAL], status[CONF_BURST]))
+        for conf in status[CONF_INPUTS]:
+            if CONF_SENSOR in conf:
+                sens = await cg.get_variable(conf[CONF_SENSOR])
+                cg.add(var.add_status_sensor(sens, conf[CONF_ACCURACY_DECIMALS]))
+            else:
+                sens = await cg.get_variable(conf[CONF_TEXT_SENSOR])
+                cg.add(var.add_status_text_sensor(sens))
+
+    # --- Level report quantisation ---
+    cg.add(var.set_level_prefix(config[CONF_LEVEL_PREFIX]))
+    cg.add(var.set_level_hysteresis(config[CONF_LEVEL_HYSTERESIS]))
+
+    # --- Active mute driven by a call-state binary sensor ---
+    if active_mute := config.get(CONF_ACTIVE_MUTE):
+        call = await cg.get_variable(active_mute[CONF_CALL_SENSOR])
+        cg.add(var.set_active_mute_sensor(call))
+        cg.add(var.set_active_mute_interval(active_mute[CONF_KEEPALIVE_INTERVAL]))
+
+    # --- Channel table change automations ---
+    for conf in config.get(CONF_ON_CHANNEL_TABLE_CHANGE, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.uint32, "hash")], conf)
+
+    # --- Line pattern automations, compiled into one matcher ---
+    if on_line := config.get(CONF_ON_LINE):
+        patterns = [conf[CONF_PATTERN] for conf in on_line]
+        nodes, terms = _compile_line_patterns(patterns)
+        prefix = f"{config[CONF_ID]}_line"
+        cg.add_global(
+            cg.RawStatement(
+                f"static const {LineMatcher}::Node {prefix}_nodes[] = {{"
+                + ", ".join(f"{{{c}, {fc}, {cc}, {ft}, {tc}}}" for c, fc, cc, ft, tc in nodes)
+                + "};"
+            )
+        )
+        cg.add_global(
+            cg.RawStatement(f"static const uint16_t {prefix}_terms[] = {{{', '.join(map(str, terms))}}};")
+        )
+        cg.add_global(
+            cg.RawStatement(
+                f"static const {LineMatcher}::Pattern {prefix}_patterns[] = {{"
+                + ", ".join(
+                    f"{{{cpp_string_escape(pat[len(_literal_prefix(pat)):])}}}"
+                    for pat in patterns
+                )
+                + "};"
+            )
+        )
+        cg.add(
+            var.set_line_patterns(
+                cg.RawExpression(f"{prefix}_nodes"),
+                cg.RawExpression(f"{prefix}_terms"),
+                cg.RawExpression(f"{prefix}_patterns"),
+                len(patterns),
+            )
+        )
+        for index, conf in enumerate(on_line):
+            trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var, index)
+            await automation.build_automation(
+                trigger,
+                [(cg.std_string, "line"), (cg.std_vector.template(cg.std_string), "fields")],
+                conf,
+            )
+
+    # --- Bluetooth controller mode and bring-up ---
+    bt = config[CONF_BLUETOOTH]
+    cg.add(var.set_bt_classic_only(bt[CONF_CLASSIC_ONLY]))
+    cg.add(var.set_bt_release_ble_memory(bt[CONF_RELEASE_BLE_MEMORY]))
+    cg.add(var.set_bt_start_after_network(bt[CONF_START_AFTER_NETWORK], bt[CONF_NETWORK_TIMEOUT]))
+    cg.add(var.set_bt_start_delay(bt[CONF_START_DELAY]))
+
+    # --- Buffers sized up front, no heap growth after setup() ---
+    if no_heap := config.get(CONF_NO_HEAP):
+        cg.add(var.set_no_heap(True))
+        cg.add(var.set_rx_buffer_size(no_heap[CONF_RX_BUFFER_SIZE]))
+        cg.add(var.set_tx_queue_size(no_heap[CONF_TX_QUEUE_SIZE]))
+        cg.add(var.set_max_command_length(no_heap[CONF_MAX_COMMAND_LENGTH]))
+        cg.add(var.set_channel_table_size(no_heap[CONF_CHANNEL_TABLE_SIZE]))
+        if no_heap[CONF_CHECK_ALLOCATIONS]:
+            cg.add_define("USE_XRS_HEAP_CHECK")
+            add_idf_sdkconfig_option("CONFIG_HEAP_USE_HOOKS", True)
+
+    # --- Optional runtime metrics ---
+    if metrics := config.get(CONF_METRICS):
+        cg.add(var.set_metrics_interval(metrics[CONF_UPDATE_INTERVAL]))
+        for key, (type_enum, _) in XRS_RADIO_METRICS.items():
+            if key in metrics:
+                sens = await sensor_comp.new_sensor(metrics[key])
+                cg.add(var.register_metric_sensor(type_enum, sens))
+
+
+@automation.register_action(
+    "xrs_radio.export_events",
+    ExportEventsAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(XRSRadioComponent),
+            cv.Optional(CONF_MAX_EVENTS, default=0): cv.templatable(cv.uint16_t),
+        }
+    ),
+)
+async def export_events_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    max_events = await cg.templatable(config[CONF_MAX_EVENTS], args, cg.uint16)
+    cg.add(var.set_max_events(max_events))
+    return var
+
+
+@automation.register_action(
+    "xrs_radio.export_channel_table",
+    ExportChannelTableAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(XRSRadioComponent),
+            cv.Optional(CONF_FORMAT, default="csv"): cv.enum(XRS_TABLE_EXPORT_FORMATS, lower=True),
+        }
+    ),
+)
+async def export_channel_table_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    cg.add(var.set_format(config[CONF_FORMAT]))
+    return var
+
+
+@automation.register_action(
+    "xrs_radio.tune_frequency",
+    TuneFrequencyAction,
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.use_id(XRSRadioComponent),
+            # MHz, matched against the channel table's RX or TX frequency
+            cv.Required(CONF_FREQUENCY): cv.templatable(cv.positive_float),
+            cv.Optional(CONF_BAND, default="rx"): cv.enum(XRS_FREQUENCY_BANDS, lower=True),
+            # Half a 12.5 kHz UHF CB channel step by default
+            cv.Optional(CONF_TOLERANCE, default=0.00625): cv.templatable(cv.positive_float),
+        }
+    ),
+)
+async def tune_frequency_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    frequency = await cg.templatable(config[CONF_FREQUENCY], args, cg.float_)
+    cg.add(var.set_frequency(frequency))
+    tolerance = await cg.templatable(config[CONF_TOLERANCE], args, cg.float_)
+    cg.add(var.set_tolerance(tolerance))
+    cg.add(var.set_band(config[CONF_BAND]))
+    return var
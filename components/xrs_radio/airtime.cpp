@@ -0,0 +1,160 @@
+#include "airtime.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Add the part of [from, to) that falls into each bucket of a ring, skipping
+// buckets that are already outside the ring's window ending at `now`.
+template<size_t N>
+static void add_to_ring(uint16_t (&ring)[N], uint32_t bucket_ms, uint64_t now, uint64_t from,
+                        uint64_t to) {
+  const uint64_t current = now / bucket_ms;
+  while (from < to) {
+    const uint64_t idx = from / bucket_ms;
+    const uint64_t seg_end = std::min<uint64_t>(to, (idx + 1) * bucket_ms);
+    if (idx + N > current) {
+      uint32_t v = ring[idx % N] + static_cast<uint32_t>(seg_end - from);
+      ring[idx % N] = static_cast<uint16_t>(std::min<uint32_t>(v, bucket_ms));
+    }
+    from = seg_end;
+  }
+}
+
+void AirtimeTracker::advance_(uint32_t now) {
+  if (!this->started_) {
+    this->started_ = true;
+    this->last_millis_ = now;
+    return;
+  }
+  const uint64_t old_clock = this->clock_ms_;
+  this->clock_ms_ += static_cast<uint32_t>(now - this->last_millis_);
+  this->last_millis_ = now;
+
+  const uint64_t old_fine = old_clock / FINE_MS;
+  const uint64_t new_fine = this->clock_ms_ / FINE_MS;
+  const uint64_t fine_steps = std::min<uint64_t>(new_fine - old_fine, FINE_BUCKETS);
+  const uint64_t old_coarse = old_clock / COARSE_MS;
+  const uint64_t new_coarse = this->clock_ms_ / COARSE_MS;
+  const uint64_t coarse_steps = std::min<uint64_t>(new_coarse - old_coarse, COARSE_BUCKETS);
+
+  for (size_t i = 0; i < this->size_; i++) {
+    Entry &e = this->entries_[i];
+    for (uint64_t k = 1; k <= fine_steps; k++)
+      e.fine[(old_fine + k) % FINE_BUCKETS] = 0;
+    for (uint64_t k = 1; k <= coarse_steps; k++)
+      e.coarse[(old_coarse + k) % COARSE_BUCKETS] = 0;
+  }
+}
+
+void AirtimeTracker::attribute_(Entry &entry, uint64_t from, uint64_t to) {
+  if (to <= from)
+    return;
+  entry.total_ms += to - from;
+  add_to_ring(entry.fine, FINE_MS, this->clock_ms_, from, to);
+  add_to_ring(entry.coarse, COARSE_MS, this->clock_ms_, from, to);
+}
+
+uint32_t AirtimeTracker::coarse_sum_(const Entry &entry, size_t buckets) const {
+  const uint64_t current = this->clock_ms_ / COARSE_MS;
+  uint32_t sum = 0;
+  for (size_t k = 0; k < buckets; k++)
+    sum += entry.coarse[(current + COARSE_BUCKETS - k) % COARSE_BUCKETS];
+  return sum;
+}
+
+uint8_t AirtimeTracker::lookup_(uint8_t zone, uint8_t channel) {
+  for (size_t i = 0; i < this->size_; i++) {
+    if (this->entries_[i].zone == zone && this->entries_[i].channel == channel)
+      return static_cast<uint8_t>(i);
+  }
+
+  size_t slot = this->size_;
+  if (slot == CAPACITY) {
+    // Evict the quietest channel that is not currently transmitting.
+    uint32_t quietest = UINT32_MAX;
+    for (size_t i = 0; i < CAPACITY; i++) {
+      if (i == this->active_)
+        continue;
+      const uint32_t busy = this->coarse_sum_(this->entries_[i], COARSE_BUCKETS);
+      if (busy < quietest) {
+        quietest = busy;
+        slot = i;
+      }
+    }
+  } else {
+    this->size_++;
+  }
+
+  Entry &e = this->entries_[slot];
+  e = Entry{};
+  e.zone = zone;
+  e.channel = channel;
+  return static_cast<uint8_t>(slot);
+}
+
+void AirtimeTracker::ptt_start(uint32_t now, uint8_t zone, uint8_t channel) {
+  this->update(now);
+  if (this->active())
+    return;
+  this->active_ = this->lookup_(zone, channel);
+  this->active_since_ = this->clock_ms_;
+  this->entries_[this->active_].transmissions++;
+}
+
+void AirtimeTracker::ptt_stop(uint32_t now) {
+  this->update(now);
+  this->active_ = NONE;
+}
+
+void AirtimeTracker::update(uint32_t now) {
+  this->advance_(now);
+  if (this->active()) {
+    this->attribute_(this->entries_[this->active_], this->active_since_, this->clock_ms_);
+    this->active_since_ = this->clock_ms_;
+  }
+}
+
+size_t AirtimeTracker::ranking(uint8_t *order) const {
+  uint32_t busy[CAPACITY];
+  for (size_t i = 0; i < this->size_; i++) {
+    order[i] = static_cast<uint8_t>(i);
+    busy[i] = this->coarse_sum_(this->entries_[i], COARSE_BUCKETS);
+  }
+  std::sort(order, order + this->size_, [&](uint8_t a, uint8_t b) {
+    if (busy[a] != busy[b])
+      return busy[a] > busy[b];
+    return this->entries_[a].total_ms > this->entries_[b].total_ms;
+  });
+  return this->size_;
+}
+
+void AirtimeTracker::stats(size_t index, Stats &out) const {
+  const Entry &e = this->entries_[index];
+  uint32_t fine = 0;
+  for (uint16_t v : e.fine)
+    fine += v;
+  out.zone = e.zone;
+  out.channel = e.channel;
+  out.transmissions = e.transmissions;
+  out.seconds = e.total_ms / 1000.0f;
+  out.duty_1m = this->duty_(fine, FINE_MS, FINE_BUCKETS);
+  out.duty_15m = this->duty_(this->coarse_sum_(e, 15), COARSE_MS, 15);
+  out.duty_1h = this->duty_(this->coarse_sum_(e, COARSE_BUCKETS), COARSE_MS, COARSE_BUCKETS);
+}
+
+float AirtimeTracker::duty_(uint32_t airtime_ms, uint32_t bucket_ms, size_t buckets) const {
+  // The newest bucket is only partly elapsed, and right after boot the
+  // window has not filled yet; divide by the time the buckets actually cover.
+  uint64_t span = (buckets - 1) * static_cast<uint64_t>(bucket_ms) + this->clock_ms_ % bucket_ms;
+  if (span > this->clock_ms_)
+    span = this->clock_ms_;
+  if (span == 0)
+    return 0.0f;
+  const float duty = airtime_ms / static_cast<float>(span);
+  return duty > 1.0f ? 1.0f : duty;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
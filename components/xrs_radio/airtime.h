@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Per-channel PTT airtime accounting in constant memory.
+//
+// Each tracked (zone, channel) keeps lifetime totals plus two rings of
+// airtime buckets: 6 x 10 s for the 1 minute duty cycle and 60 x 1 min for
+// the 15 minute and 1 hour duty cycles. All rings are aligned to one shared
+// clock, so aging is a matter of zeroing the buckets the clock moved past.
+// When the table is full the least busy channel (by 1 hour airtime) is
+// evicted to make room.
+class AirtimeTracker {
+ public:
+  static constexpr size_t CAPACITY = 16;
+
+  struct Stats {
+    uint8_t zone;
+    uint8_t channel;
+    uint32_t transmissions;
+    float seconds;
+    // Fraction of the window spent transmitting, 0.0 - 1.0.
+    float duty_1m;
+    float duty_15m;
+    float duty_1h;
+  };
+
+  // A transmission started on the given channel.
+  void ptt_start(uint32_t now, uint8_t zone, uint8_t channel);
+
+  // The current transmission ended.
+  void ptt_stop(uint32_t now);
+
+  // Account any in-progress transmission up to `now` and age the windows.
+  void update(uint32_t now);
+
+  bool active() const { return this->active_ != NONE; }
+  size_t size() const { return this->size_; }
+
+  // Write entry indices ordered busiest-first (by 1 hour airtime) into
+  // `order`, which must hold CAPACITY entries. Returns the number written.
+  size_t ranking(uint8_t *order) const;
+
+  // Snapshot of the entry at `index` (as returned by ranking()).
+  void stats(size_t index, Stats &out) const;
+
+ protected:
+  static constexpr uint8_t NONE = 0xFF;
+  static constexpr uint32_t FINE_MS = 10000;
+  static constexpr size_t FINE_BUCKETS = 6;
+  static constexpr uint32_t COARSE_MS = 60000;
+  static constexpr size_t COARSE_BUCKETS = 60;
+
+  struct Entry {
+    uint8_t zone;
+    uint8_t channel;
+    uint32_t transmissions;
+    uint64_t total_ms;
+    uint16_t fine[FINE_BUCKETS];
+    uint16_t coarse[COARSE_BUCKETS];
+  };
+
+  // Advance the shared clock to `now`, zeroing buckets that fell out of
+  // their window.
+  void advance_(uint32_t now);
+
+  // Add airtime between two points on the shared clock to an entry.
+  void attribute_(Entry &entry, uint64_t from, uint64_t to);
+
+  uint32_t coarse_sum_(const Entry &entry, size_t buckets) const;
+
+  // Airtime as a fraction of the span covered by the newest `buckets` buckets.
+  float duty_(uint32_t airtime_ms, uint32_t bucket_ms, size_t buckets) const;
+
+  // Find or allocate the entry for a channel.
+  uint8_t lookup_(uint8_t zone, uint8_t channel);
+
+  Entry entries_[CAPACITY]{};
+  size_t size_{0};
+
+  // Shared monotonic clock (ms), immune to millis() wrap-around.
+  bool started_{false};
+  uint32_t last_millis_{0};
+  uint64_t clock_ms_{0};
+
+  // Active transmission: entry index and accounted-up-to time.
+  uint8_t active_{NONE};
+  uint64_t active_since_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
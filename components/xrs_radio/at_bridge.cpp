@@ -0,0 +1,312 @@
+#include "at_bridge.h"
+
+#ifdef USE_XRS_AT_BRIDGE
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+static const char *const TAG = "xrs_radio.at_bridge";
+
+static bool starts_with(const std::string &s, const char *prefix) {
+  const size_t len = strlen(prefix);
+  return s.size() >= len && s.compare(0, len, prefix) == 0;
+}
+
+static bool is_local_ipv4(const uint8_t *b) {
+  return b[0] == 127 || b[0] == 10 || (b[0] == 172 && (b[1] & 0xF0) == 16) || (b[0] == 192 && b[1] == 168) ||
+         (b[0] == 169 && b[1] == 254);
+}
+
+void ATBridge::set_max_clients(uint8_t clients) {
+  this->max_clients_ = std::max<uint8_t>(1, std::min<uint8_t>(clients, MAX_CLIENTS));
+}
+
+size_t ATBridge::client_count() const {
+  size_t count = 0;
+  for (size_t i = 0; i < this->max_clients_; i++) {
+    if (this->clients_[i].sock != nullptr)
+      count++;
+  }
+  return count;
+}
+
+bool ATBridge::start() {
+  this->storage_ = std::unique_ptr<char[]>(new char[this->max_clients_ * this->buffer_size_]);
+  for (size_t i = 0; i < this->max_clients_; i++)
+    this->clients_[i].out = this->storage_.get() + i * this->buffer_size_;
+
+  this->listener_ = socket::socket_ip(SOCK_STREAM, 0);
+  if (this->listener_ == nullptr) {
+    ESP_LOGE(TAG, "Could not create socket");
+    return false;
+  }
+  int enable = 1;
+  this->listener_->setsockopt(SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+  this->listener_->setblocking(false);
+
+  struct sockaddr_storage server;
+  socklen_t len = socket::set_sockaddr_any(reinterpret_cast<struct sockaddr *>(&server), sizeof(server), this->port_);
+  if (len == 0 || this->listener_->bind(reinterpret_cast<struct sockaddr *>(&server), len) != 0) {
+    ESP_LOGE(TAG, "Could not bind to port %u: errno %d", this->port_, errno);
+    this->listener_.reset();
+    return false;
+  }
+  if (this->listener_->listen(this->max_clients_) != 0) {
+    ESP_LOGE(TAG, "Could not listen on port %u: errno %d", this->port_, errno);
+    this->listener_.reset();
+    return false;
+  }
+  ESP_LOGI(TAG, "Listening on port %u (max %u clients)", this->port_, this->max_clients_);
+  return true;
+}
+
+void ATBridge::poll(uint32_t now, const SubmitFn &submit) {
+  if (this->listener_ == nullptr)
+    return;
+
+  // Commands the radio never answered: their late responses get fanned out.
+  while (this->inflight_count_ > 0 && now - this->inflight_[this->inflight_head_].sent_at > INFLIGHT_TIMEOUT_MS) {
+    this->inflight_head_ = (this->inflight_head_ + 1) % INFLIGHT_MAX;
+    this->inflight_count_--;
+  }
+
+  this->accept_();
+  for (uint8_t slot = 0; slot < this->max_clients_; slot++) {
+    if (this->clients_[slot].sock != nullptr)
+      this->flush_(this->clients_[slot]);
+    if (this->clients_[slot].sock != nullptr)
+      this->read_(slot, submit);
+  }
+}
+
+void ATBridge::accept_() {
+  while (true) {
+    struct sockaddr_storage addr;
+    socklen_t addr_len = sizeof(addr);
+    auto sock = this->listener_->accept(reinterpret_cast<struct sockaddr *>(&addr), &addr_len);
+    if (sock == nullptr)
+      return;
+
+    if (!is_local_peer_(addr)) {
+      ESP_LOGW(TAG, "Rejected non-local client %s", sock->getpeername().c_str());
+      sock->close();
+      continue;
+    }
+
+    uint8_t slot = 0;
+    while (slot < this->max_clients_ && this->clients_[slot].sock != nullptr)
+      slot++;
+    if (slot == this->max_clients_) {
+      ESP_LOGW(TAG, "Rejected client %s: all %u slots in use", sock->getpeername().c_str(), this->max_clients_);
+      sock->close();
+      continue;
+    }
+
+    sock->setblocking(false);
+    Client &c = this->clients_[slot];
+    ESP_LOGI(TAG, "Client %u connected from %s", slot, sock->getpeername().c_str());
+    c.sock = std::move(sock);
+    c.out_head = 0;
+    c.out_len = 0;
+    c.in_len = 0;
+    c.in_discard = false;
+    c.overflows = 0;
+  }
+}
+
+void ATBridge::flush_(Client &c) {
+  while (c.out_len > 0) {
+    const size_t chunk = std::min<size_t>(c.out_len, this->buffer_size_ - c.out_head);
+    const ssize_t n = c.sock->write(c.out + c.out_head, chunk);
+    if (n < 0) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+        return;
+      this->close_(static_cast<uint8_t>(&c - this->clients_), "write error");
+      return;
+    }
+    if (n == 0)
+      return;
+    c.out_head = (c.out_head + n) % this->buffer_size_;
+    c.out_len -= n;
+  }
+}
+
+void ATBridge::read_(uint8_t slot, const SubmitFn &submit) {
+  Client &c = this->clients_[slot];
+  size_t budget = READ_BUDGET;
+  while (true) {
+    // Hand over complete lines first. A line the hub cannot take yet stays
+    // buffered, and nothing more is read until it goes through.
+    while (true) {
+      char *end = nullptr;
+      for (size_t i = 0; i < c.in_len; i++) {
+        if (c.in[i] == '\r' || c.in[i] == '\n') {
+          end = c.in + i;
+          break;
+        }
+      }
+      if (end == nullptr)
+        break;
+      const size_t len = end - c.in;
+      if (!c.in_discard && len > 0) {
+        if (!submit(slot, std::string(c.in, len)))
+          return;
+      }
+      c.in_discard = false;
+      c.in_len -= len + 1;
+      memmove(c.in, end + 1, c.in_len);
+    }
+
+    if (budget == 0)
+      return;
+    if (c.in_len == MAX_LINE) {
+      ESP_LOGW(TAG, "Client %u sent a line over %u bytes, dropping it", slot, static_cast<unsigned>(MAX_LINE));
+      c.in_len = 0;
+      c.in_discard = true;
+    }
+    const ssize_t n = c.sock->read(c.in + c.in_len, std::min(MAX_LINE - c.in_len, budget));
+    if (n == 0) {
+      this->close_(slot, "closed by client");
+      return;
+    }
+    if (n < 0) {
+      if (errno != EAGAIN && errno != EWOULDBLOCK)
+        this->close_(slot, "read error");
+      return;
+    }
+    c.in_len += n;
+    budget -= n;
+  }
+}
+
+void ATBridge::close_(uint8_t slot, const char *reason) {
+  Client &c = this->clients_[slot];
+  ESP_LOGI(TAG, "Client %u disconnected (%s)", slot, reason);
+  c.sock->close();
+  c.sock.reset();
+  c.out_len = 0;
+  c.in_len = 0;
+  // Answers to its outstanding commands have nowhere to go.
+  for (size_t i = 0; i < this->inflight_count_; i++) {
+    InFlight &f = this->inflight_[(this->inflight_head_ + i) % INFLIGHT_MAX];
+    if (f.owner == slot)
+      f.owner = OWNER_NONE;
+  }
+}
+
+void ATBridge::write_line_(Client &c, const char *line, size_t len) {
+  if (this->buffer_size_ - c.out_len < len + 2) {
+    this->dropped_lines_++;
+    if (++c.overflows >= MAX_OVERFLOWS)
+      this->close_(static_cast<uint8_t>(&c - this->clients_), "too slow");
+    return;
+  }
+  c.overflows = 0;
+  size_t tail = (c.out_head + c.out_len) % this->buffer_size_;
+  auto put = [&](const char *src, size_t n) {
+    const size_t first = std::min(n, this->buffer_size_ - tail);
+    memcpy(c.out + tail, src, first);
+    memcpy(c.out, src + first, n - first);
+    tail = (tail + n) % this->buffer_size_;
+    c.out_len += n;
+  };
+  put(line, len);
+  put("\r\n", 2);
+}
+
+void ATBridge::send_to(uint8_t owner, const char *line) {
+  if (owner < this->max_clients_ && this->clients_[owner].sock != nullptr)
+    this->write_line_(this->clients_[owner], line, strlen(line));
+}
+
+void ATBridge::route_(uint8_t owner, const std::string &line) {
+  if (owner == OWNER_HUB || owner == OWNER_NONE)
+    return;
+  if (owner < this->max_clients_ && this->clients_[owner].sock != nullptr)
+    this->write_line_(this->clients_[owner], line.data(), line.size());
+}
+
+void ATBridge::on_command_sent(uint32_t now, uint8_t owner, const std::string &cmd) {
+  if (this->listener_ == nullptr)
+    return;
+  if (this->inflight_count_ == INFLIGHT_MAX) {
+    this->inflight_head_ = (this->inflight_head_ + 1) % INFLIGHT_MAX;
+    this->inflight_count_--;
+  }
+  InFlight &f = this->inflight_[(this->inflight_head_ + this->inflight_count_) % INFLIGHT_MAX];
+  this->inflight_count_++;
+  f.sent_at = now;
+  f.owner = owner;
+
+  // "AT+GMI?" answers with "+GMI: ...", "AT_WGCHSQ" with "+WGCHSQ: ...".
+  size_t n = 0;
+  if (cmd.size() > 3 && (cmd[0] == 'A' || cmd[0] == 'a') && (cmd[1] == 'T' || cmd[1] == 't') &&
+      (cmd[2] == '+' || cmd[2] == '_')) {
+    f.prefix[n++] = '+';
+    for (size_t i = 3; i < cmd.size() && n < PREFIX_MAX - 1 && isalnum(static_cast<unsigned char>(cmd[i])); i++)
+      f.prefix[n++] = static_cast<char>(toupper(static_cast<unsigned char>(cmd[i])));
+  }
+  f.prefix[n] = '\0';
+}
+
+void ATBridge::on_line(const std::string &line) {
+  if (this->listener_ == nullptr)
+    return;
+
+  if (this->inflight_count_ > 0) {
+    InFlight &head = this->inflight_[this->inflight_head_];
+    if (line == "OK" || line == "ERROR" || starts_with(line, "+CME ERROR")) {
+      this->route_(head.owner, line);
+      this->inflight_head_ = (this->inflight_head_ + 1) % INFLIGHT_MAX;
+      this->inflight_count_--;
+      return;
+    }
+    // Echoes and plain responses belong to the command in flight, as do
+    // lines carrying its response prefix.
+    const size_t plen = strlen(head.prefix);
+    if (line[0] != '+' ||
+        (plen > 0 && starts_with(line, head.prefix) && line.size() > plen && line[plen] == ':')) {
+      this->route_(head.owner, line);
+      return;
+    }
+  }
+
+  // Unsolicited: every client gets it.
+  for (uint8_t slot = 0; slot < this->max_clients_; slot++) {
+    if (this->clients_[slot].sock != nullptr)
+      this->write_line_(this->clients_[slot], line.data(), line.size());
+  }
+}
+
+bool ATBridge::is_local_peer_(const struct sockaddr_storage &addr) {
+  if (addr.ss_family == AF_INET) {
+    const auto *sin = reinterpret_cast<const struct sockaddr_in *>(&addr);
+    return is_local_ipv4(reinterpret_cast<const uint8_t *>(&sin->sin_addr.s_addr));
+  }
+#ifdef AF_INET6
+  if (addr.ss_family == AF_INET6) {
+    const auto *sin6 = reinterpret_cast<const struct sockaddr_in6 *>(&addr);
+    const uint8_t *b = reinterpret_cast<const uint8_t *>(&sin6->sin6_addr);
+    static const uint8_t V4_MAPPED[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xFF, 0xFF};
+    static const uint8_t LOOPBACK[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1};
+    if (memcmp(b, V4_MAPPED, sizeof(V4_MAPPED)) == 0)
+      return is_local_ipv4(b + 12);
+    // ::1, link-local fe80::/10 and unique-local fc00::/7.
+    return memcmp(b, LOOPBACK, sizeof(LOOPBACK)) == 0 || (b[0] == 0xFE && (b[1] & 0xC0) == 0x80) ||
+           (b[0] & 0xFE) == 0xFC;
+  }
+#endif
+  return false;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
+
+#endif  // USE_XRS_AT_BRIDGE
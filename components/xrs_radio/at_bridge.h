@@ -0,0 +1,124 @@
+#pragma once
+
+#include "esphome/core/defines.h"
+
+#ifdef USE_XRS_AT_BRIDGE
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "esphome/components/socket/socket.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+// Raw AT-over-TCP bridge sharing the radio's single SPP link.
+//
+// Clients send AT command lines, which the hub queues on its own TX queue
+// tagged with the client's slot. Every command actually written to the
+// radio is recorded here in order, so response lines go back to whoever
+// sent the command. That covers echoes, lines carrying the command's prefix
+// (e.g. "+GMI:" for AT+GMI?) and the final OK/ERROR. Anything else, such as
+// "+WG..." notifications, is fanned out to every client.
+//
+// Each client has a fixed output ring allocated in start(). A client that
+// cannot keep up loses lines instead of stalling the hub, and is
+// disconnected after MAX_OVERFLOWS lost lines in a row. Input is read
+// only while the hub accepts commands, so a full TX queue pushes back on
+// the client through TCP. Only peers on loopback, private or link-local
+// addresses are accepted.
+class ATBridge {
+ public:
+  static constexpr size_t MAX_CLIENTS = 4;
+  static constexpr size_t MAX_LINE = 128;
+  static constexpr uint8_t MAX_OVERFLOWS = 16;
+  // Owner tags for commands the hub sent itself / whose client went away.
+  static constexpr uint8_t OWNER_HUB = 0xFF;
+  static constexpr uint8_t OWNER_NONE = 0xFE;
+
+  // Accept a command line from `owner`; return false to retry it later.
+  using SubmitFn = std::function<bool(uint8_t owner, const std::string &line)>;
+
+  void set_port(uint16_t port) { this->port_ = port; }
+  void set_max_clients(uint8_t clients);
+  void set_buffer_size(uint16_t bytes) { this->buffer_size_ = bytes; }
+
+  uint16_t port() const { return this->port_; }
+  uint8_t max_clients() const { return this->max_clients_; }
+  uint16_t buffer_size() const { return this->buffer_size_; }
+  size_t client_count() const;
+  uint32_t dropped_lines() const { return this->dropped_lines_; }
+
+  // Allocate client buffers and open the listening socket.
+  bool start();
+
+  // Accept new clients, flush pending output and read client input. Complete
+  // lines are handed to `submit`.
+  void poll(uint32_t now, const SubmitFn &submit);
+
+  // The hub wrote a command to the radio on behalf of `owner`.
+  void on_command_sent(uint32_t now, uint8_t owner, const std::string &cmd);
+
+  // A line arrived from the radio: route it to its requester or fan it out.
+  void on_line(const std::string &line);
+
+  // Queue a line for one client (e.g. "ERROR" for a command that could not
+  // be sent).
+  void send_to(uint8_t owner, const char *line);
+
+  // The SPP link dropped: nothing in flight will be answered any more.
+  void on_link_closed() { this->inflight_count_ = 0; }
+
+ protected:
+  static constexpr size_t INFLIGHT_MAX = 16;
+  static constexpr size_t PREFIX_MAX = 12;
+  static constexpr uint32_t INFLIGHT_TIMEOUT_MS = 5000;
+  static constexpr size_t READ_BUDGET = 256;
+
+  struct Client {
+    std::unique_ptr<socket::Socket> sock;
+    char *out{nullptr};
+    size_t out_head{0};
+    size_t out_len{0};
+    char in[MAX_LINE];
+    size_t in_len{0};
+    // Input line was too long; discard up to the next newline.
+    bool in_discard{false};
+    uint8_t overflows{0};
+  };
+
+  struct InFlight {
+    uint32_t sent_at;
+    uint8_t owner;
+    // Response prefix, e.g. "+GMI" for AT+GMI? (empty for plain commands).
+    char prefix[PREFIX_MAX];
+  };
+
+  void accept_();
+  void flush_(Client &client);
+  void read_(uint8_t slot, const SubmitFn &submit);
+  void close_(uint8_t slot, const char *reason);
+  void write_line_(Client &client, const char *line, size_t len);
+  void route_(uint8_t owner, const std::string &line);
+  static bool is_local_peer_(const struct sockaddr_storage &addr);
+
+  uint16_t port_{2323};
+  uint8_t max_clients_{2};
+  uint16_t buffer_size_{1024};
+  std::unique_ptr<socket::Socket> listener_;
+  Client clients_[MAX_CLIENTS];
+  std::unique_ptr<char[]> storage_;
+
+  InFlight inflight_[INFLIGHT_MAX];
+  size_t inflight_head_{0};
+  size_t inflight_count_{0};
+  uint32_t dropped_lines_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
+
+#endif  // USE_XRS_AT_BRIDGE
@@ -57,5 +57,37 @@ std::vector<std::string> ATParser::split_args(const std::string &payload) {
   return result;
 }
 
+size_t ATParser::split_fields(const char *payload, size_t len, Field *fields, size_t max) {
+  if (max == 0)
+    return 0;
+  size_t count = 0;
+  size_t start = 0;
+  bool in_quotes = false;
+  for (size_t i = 0; i <= len; i++) {
+    if (i < len) {
+      if (payload[i] == '\"')
+        in_quotes = !in_quotes;
+      if (payload[i] != ',' || in_quotes)
+        continue;
+    }
+    // A trailing empty field is dropped, as in split_args().
+    if (i == len && i == start)
+      break;
+    size_t b = start;
+    size_t e = i;
+    while (b < e && std::isspace(static_cast<unsigned char>(payload[b])))
+      ++b;
+    while (e > b && std::isspace(static_cast<unsigned char>(payload[e - 1])))
+      --e;
+    Field &f = fields[count < max ? count : max - 1];
+    f.start = static_cast<uint16_t>(b);
+    f.len = static_cast<uint16_t>(e - b);
+    if (count < max)
+      count++;
+    start = i + 1;
+  }
+  return count;
+}
+
 }  // namespace xrs_radio
 }  // namespace esphome
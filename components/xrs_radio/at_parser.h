@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -17,6 +19,17 @@ class ATParser {
   // Split a comma-separated payload into fields, keeping quoted strings intact.
   // Whitespace around fields is trimmed but quotes are preserved.
   static std::vector<std::string> split_args(const std::string &payload);
+
+  // Byte range of one field within a payload.
+  struct Field {
+    uint16_t start;
+    uint16_t len;
+  };
+
+  // split_args() without allocating: store the ranges of up to `max` fields
+  // of `payload` in `fields` and return how many were stored. Fields past
+  // `max` replace the last one, so it always holds the final field.
+  static size_t split_fields(const char *payload, size_t len, Field *fields, size_t max);
 };
 
 }  // namespace xrs_radio
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "xrs_radio.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+// on_channel_table_change: fires with the new table hash when a table load
+// added, changed or removed channels.
+class ChannelTableChangeTrigger : public Trigger<uint32_t> {
+ public:
+  explicit ChannelTableChangeTrigger(XRSRadioComponent *parent) {
+    parent->add_on_channel_table_change_callback([this](uint32_t hash) { this->trigger(hash); });
+  }
+};
+
+// on_line: fires with the line and its '*' fields when pattern `index`
+// (see LineMatcher) matches a line from the radio.
+class LineTrigger : public Trigger<std::string, std::vector<std::string>> {
+ public:
+  LineTrigger(XRSRadioComponent *parent, uint16_t index) { parent->register_line_trigger(index, this); }
+};
+
+// xrs_radio.export_events: stream the event history to the log and any
+// event_export text sensors.
+template<typename... Ts> class ExportEventsAction : public Action<Ts...>, public Parented<XRSRadioComponent> {
+ public:
+  TEMPLATABLE_VALUE(uint16_t, max_events)
+
+  void play(Ts... x) override { this->parent_->export_events(this->max_events_.value(x...)); }
+};
+
+// xrs_radio.export_channel_table: stream the channel table as CSV or JSON.
+template<typename... Ts> class ExportChannelTableAction : public Action<Ts...>, public Parented<XRSRadioComponent> {
+ public:
+  void set_format(XRSTableExportFormat format) { this->format_ = format; }
+
+  void play(Ts... x) override { this->parent_->export_channel_table(this->format_); }
+
+ protected:
+  XRSTableExportFormat format_{XRS_TABLE_EXPORT_CSV};
+};
+
+// xrs_radio.tune_frequency: switch to the channel closest to a frequency.
+template<typename... Ts> class TuneFrequencyAction : public Action<Ts...>, public Parented<XRSRadioComponent> {
+ public:
+  TEMPLATABLE_VALUE(float, frequency)
+  TEMPLATABLE_VALUE(float, tolerance)
+  void set_band(XRSFrequencyBand band) { this->band_ = band; }
+
+  void play(Ts... x) override {
+    this->parent_->tune_to_frequency(this->frequency_.value(x...), this->band_, this->tolerance_.value(x...));
+  }
+
+ protected:
+  XRSFrequencyBand band_{XRS_FREQ_RX};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
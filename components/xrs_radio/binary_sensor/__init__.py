@@ -18,6 +18,7 @@ XRS_RADIO_BINARY_TYPES = {
     "silent_memory": XRSBinarySensorType.XRS_BIN_SILENT_MEMORY,
     "quiet_memory": XRSBinarySensorType.XRS_BIN_QUIET_MEMORY,
     "quiet_mode": XRSBinarySensorType.XRS_BIN_QUIET_MODE,
+    "ready": XRSBinarySensorType.XRS_BIN_READY,
 }
 
 CONFIG_SCHEMA = bs_base.binary_sensor_schema(XRSRadioBinarySensor).extend(
@@ -0,0 +1,89 @@
+#include "event_log.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+namespace esphome {
+namespace xrs_radio {
+
+void EventLog::init(size_t capacity) {
+  if (this->events_ != nullptr || capacity == 0)
+    return;
+  this->events_.reset(new XRSEvent[capacity]);
+  this->capacity_ = capacity;
+}
+
+XRSEvent &EventLog::push(uint32_t now, XRSEventType type) {
+  if (!this->started_) {
+    this->started_ = true;
+    this->clock_ms_ = now;
+  } else {
+    this->clock_ms_ += static_cast<uint32_t>(now - this->last_millis_);
+  }
+  this->last_millis_ = now;
+
+  XRSEvent &e = this->events_[this->next_seq_ % this->capacity_];
+  e.time_ms = this->clock_ms_;
+  e.seq = this->next_seq_++;
+  e.value = 0;
+  e.type = type;
+  e.zone = 0;
+  e.channel = 0;
+  e.text[0] = '\0';
+  if (this->count_ < this->capacity_)
+    this->count_++;
+  return e;
+}
+
+const XRSEvent *EventLog::find(uint32_t seq) const {
+  if (this->count_ == 0)
+    return nullptr;
+  if (static_cast<uint32_t>(seq - this->oldest_seq()) >= this->count_)
+    return nullptr;
+  return &this->events_[seq % this->capacity_];
+}
+
+size_t EventLog::format(const XRSEvent &e, char *buf, size_t len) {
+  const uint32_t secs = static_cast<uint32_t>(e.time_ms / 1000);
+  const unsigned ms = static_cast<unsigned>(e.time_ms % 1000);
+  int n = 0;
+  switch (e.type) {
+    case XRS_EVENT_CONNECTED:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us connected", e.seq, secs, ms);
+      break;
+    case XRS_EVENT_DISCONNECTED:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us disconnected", e.seq, secs, ms);
+      break;
+    case XRS_EVENT_PTT_START:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us PTT start Z%u/Ch%u%s", e.seq, secs, ms, e.zone,
+                   e.channel, e.value == 2 ? " (data)" : "");
+      break;
+    case XRS_EVENT_PTT_STOP:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us PTT stop Z%u/Ch%u after %" PRId32 ".%03" PRId32 "s",
+                   e.seq, secs, ms, e.zone, e.channel, e.value / 1000, e.value % 1000);
+      break;
+    case XRS_EVENT_CHANNEL_CHANGE:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us channel Z%u/Ch%u", e.seq, secs, ms, e.zone, e.channel);
+      break;
+    case XRS_EVENT_POWER_STATE:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us power state %" PRId32, e.seq, secs, ms, e.value);
+      break;
+    case XRS_EVENT_SCAN:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us scan %s", e.seq, secs, ms, e.value ? "on" : "off");
+      break;
+    case XRS_EVENT_UNKNOWN_LINE:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us line %s", e.seq, secs, ms, e.text);
+      break;
+    case XRS_EVENT_TABLE_CHANGED:
+      n = snprintf(buf, len, "#%" PRIu32 " %" PRIu32 ".%03us channel table %s hash %08" PRIx32, e.seq, secs, ms,
+                   e.text, static_cast<uint32_t>(e.value));
+      break;
+  }
+  if (n < 0)
+    return 0;
+  return static_cast<size_t>(n) < len ? static_cast<size_t>(n) : len - 1;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
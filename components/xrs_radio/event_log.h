@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Kinds of radio activity recorded in the event history.
+enum XRSEventType : uint8_t {
+  XRS_EVENT_CONNECTED = 0,
+  XRS_EVENT_DISCONNECTED = 1,
+  XRS_EVENT_PTT_START = 2,
+  XRS_EVENT_PTT_STOP = 3,
+  XRS_EVENT_CHANNEL_CHANGE = 4,
+  XRS_EVENT_POWER_STATE = 5,
+  XRS_EVENT_SCAN = 6,
+  XRS_EVENT_UNKNOWN_LINE = 7,
+  XRS_EVENT_TABLE_CHANGED = 8,
+};
+
+// One history entry. `value` depends on the type: PTT stop duration (ms),
+// power state, scan on/off, or the new channel table hash. Unrecognised
+// lines keep a truncated copy; table changes keep "+added ~changed -removed".
+struct XRSEvent {
+  static constexpr size_t TEXT_MAX = 40;
+
+  uint64_t time_ms;
+  uint32_t seq;
+  int32_t value;
+  XRSEventType type;
+  uint8_t zone;
+  uint8_t channel;
+  char text[TEXT_MAX];
+};
+
+// Fixed-capacity ring of XRSEvent with monotonic timestamps. Storage is
+// allocated once by init(); afterwards the oldest entry is overwritten.
+// Every event gets an increasing sequence number so readers can walk the
+// ring while new events keep arriving.
+class EventLog {
+ public:
+  // Allocate storage for `capacity` events. Call once from setup().
+  void init(size_t capacity);
+
+  // Append a new event stamped with `now` (millis()) and return it for the
+  // caller to fill in.
+  XRSEvent &push(uint32_t now, XRSEventType type);
+
+  size_t capacity() const { return this->capacity_; }
+  size_t size() const { return this->count_; }
+  // Sequence number the next event will get.
+  uint32_t next_seq() const { return this->next_seq_; }
+  // Sequence number of the oldest event still held.
+  uint32_t oldest_seq() const { return this->next_seq_ - this->count_; }
+
+  // Look up an event by sequence number; nullptr if not (or no longer) held.
+  const XRSEvent *find(uint32_t seq) const;
+
+  // Format an event as one human-readable line. Returns the length written.
+  static size_t format(const XRSEvent &event, char *buf, size_t len);
+
+ protected:
+  std::unique_ptr<XRSEvent[]> events_;
+  size_t capacity_{0};
+  size_t count_{0};
+  uint32_t next_seq_{0};
+
+  // Monotonic clock built from millis() deltas so it survives wrap-around.
+  bool started_{false};
+  uint32_t last_millis_{0};
+  uint64_t clock_ms_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,84 @@
+#include "freq_index.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Frequencies come from "%.4f"-style text; treat anything closer than this
+// as the same frequency.
+static constexpr float EXACT_EPSILON_MHZ = 0.00005f;
+
+static bool entry_less(const FrequencyIndex::Entry &a, const FrequencyIndex::Entry &b) {
+  if (a.mhz != b.mhz)
+    return a.mhz < b.mhz;
+  if (a.zone != b.zone)
+    return a.zone < b.zone;
+  return a.channel < b.channel;
+}
+
+void FrequencyIndex::clear() {
+  this->rx_.clear();
+  this->tx_.clear();
+}
+
+void FrequencyIndex::add(uint8_t zone, uint8_t channel, float rx_mhz, float tx_mhz) {
+  if (rx_mhz > 0.0f)
+    this->rx_.push_back({rx_mhz, zone, channel});
+  if (tx_mhz > 0.0f)
+    this->tx_.push_back({tx_mhz, zone, channel});
+}
+
+void FrequencyIndex::finish() {
+  std::sort(this->rx_.begin(), this->rx_.end(), entry_less);
+  std::sort(this->tx_.begin(), this->tx_.end(), entry_less);
+  this->rx_.shrink_to_fit();
+  this->tx_.shrink_to_fit();
+}
+
+const FrequencyIndex::Entry *FrequencyIndex::nearest(XRSFrequencyBand band, float mhz, float tolerance_mhz) const {
+  const std::vector<Entry> &entries = this->entries_(band);
+  if (entries.empty())
+    return nullptr;
+
+  auto it = std::lower_bound(entries.begin(), entries.end(), mhz,
+                             [](const Entry &e, float value) { return e.mhz < value; });
+  // The closest entry is either the first one >= mhz or the one before it;
+  // on a tie the lower frequency (and lower zone/channel) wins.
+  const Entry *best = nullptr;
+  if (it != entries.end())
+    best = &*it;
+  if (it != entries.begin()) {
+    const Entry *below = &*(it - 1);
+    if (best == nullptr || std::fabs(mhz - below->mhz) <= std::fabs(best->mhz - mhz)) {
+      // Step back to the first of several channels sharing this frequency.
+      auto first = std::lower_bound(entries.begin(), it, below->mhz,
+                                    [](const Entry &e, float value) { return e.mhz < value; });
+      best = &*first;
+    }
+  }
+
+  const float limit = std::max(tolerance_mhz, EXACT_EPSILON_MHZ);
+  if (std::fabs(best->mhz - mhz) > limit)
+    return nullptr;
+  return best;
+}
+
+size_t FrequencyIndex::range(XRSFrequencyBand band, float lo, float hi, const Entry *&first) const {
+  const std::vector<Entry> &entries = this->entries_(band);
+  first = nullptr;
+  if (entries.empty() || hi < lo)
+    return 0;
+
+  auto begin = std::lower_bound(entries.begin(), entries.end(), lo,
+                                [](const Entry &e, float value) { return e.mhz < value; });
+  auto end = std::upper_bound(begin, entries.end(), hi, [](float value, const Entry &e) { return value < e.mhz; });
+  if (begin == end)
+    return 0;
+  first = &*begin;
+  return static_cast<size_t>(end - begin);
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
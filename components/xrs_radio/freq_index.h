@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Which side of a channel a frequency lookup matches against.
+enum XRSFrequencyBand : uint8_t {
+  XRS_FREQ_RX = 0,
+  XRS_FREQ_TX = 1,
+};
+
+// Sorted RX and TX frequency indexes over the channel table.
+//
+// Rebuilt once per table load with clear()/add()/finish(). Lookups then
+// binary-search a flat array of (frequency, zone, channel) entries, so
+// exact, nearest and range queries are O(log n) and never touch the table.
+// Frequencies are in MHz, as reported by +WGCHSQ:.
+class FrequencyIndex {
+ public:
+  struct Entry {
+    float mhz;
+    uint8_t zone;
+    uint8_t channel;
+  };
+
+  void clear();
+  // Add a channel; frequencies <= 0 (not reported) are left out.
+  void add(uint8_t zone, uint8_t channel, float rx_mhz, float tx_mhz);
+  // Sort the indexes. Call once after the last add().
+  void finish();
+
+  size_t size(XRSFrequencyBand band) const { return this->entries_(band).size(); }
+
+  // Closest channel to `mhz`; nullptr if the index is empty or the closest
+  // one is further away than `tolerance_mhz`. A tolerance of 0 only accepts
+  // exact matches (to float precision).
+  const Entry *nearest(XRSFrequencyBand band, float mhz, float tolerance_mhz) const;
+
+  // Channels with lo <= frequency <= hi, as a contiguous run of sorted
+  // entries starting at `first`. Returns the number of entries.
+  size_t range(XRSFrequencyBand band, float lo, float hi, const Entry *&first) const;
+
+ protected:
+  const std::vector<Entry> &entries_(XRSFrequencyBand band) const {
+    return band == XRS_FREQ_TX ? this->tx_ : this->rx_;
+  }
+
+  std::vector<Entry> rx_;
+  std::vector<Entry> tx_;
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,55 @@
+#include "heap_guard.h"
+
+#include <atomic>
+
+#include "esphome/core/defines.h"
+
+#if defined(USE_XRS_HEAP_CHECK) && defined(CONFIG_HEAP_USE_HOOKS)
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#define XRS_HEAP_HOOKS 1
+#endif
+
+namespace esphome {
+namespace xrs_radio {
+
+#ifdef XRS_HEAP_HOOKS
+// Read from the allocator of every task, so kept lock-free.
+static std::atomic<void *> armed_task{nullptr};
+static std::atomic<uint32_t> alloc_count{0};
+static std::atomic<size_t> alloc_last_size{0};
+
+bool HeapGuard::available() { return true; }
+void HeapGuard::arm() { armed_task.store(xTaskGetCurrentTaskHandle(), std::memory_order_relaxed); }
+void HeapGuard::disarm() { armed_task.store(nullptr, std::memory_order_relaxed); }
+uint32_t HeapGuard::count() { return alloc_count.load(std::memory_order_relaxed); }
+size_t HeapGuard::last_size() { return alloc_last_size.load(std::memory_order_relaxed); }
+HeapGuard::Pause::Pause() : task_(armed_task.exchange(nullptr, std::memory_order_relaxed)) {}
+HeapGuard::Pause::~Pause() {
+  if (this->task_ != nullptr)
+    armed_task.store(this->task_, std::memory_order_relaxed);
+}
+#else
+bool HeapGuard::available() { return false; }
+void HeapGuard::arm() {}
+void HeapGuard::disarm() {}
+uint32_t HeapGuard::count() { return 0; }
+size_t HeapGuard::last_size() { return 0; }
+HeapGuard::Pause::Pause() {}
+HeapGuard::Pause::~Pause() {}
+#endif
+
+}  // namespace xrs_radio
+}  // namespace esphome
+
+#ifdef XRS_HEAP_HOOKS
+// Called by ESP-IDF after every successful heap allocation.
+extern "C" void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps) {
+  using namespace esphome::xrs_radio;
+  void *task = armed_task.load(std::memory_order_relaxed);
+  if (task == nullptr || task != xTaskGetCurrentTaskHandle())
+    return;
+  alloc_count.fetch_add(1, std::memory_order_relaxed);
+  alloc_last_size.store(size, std::memory_order_relaxed);
+}
+#endif
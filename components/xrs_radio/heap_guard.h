@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Counts heap allocations made by one task while armed, through the ESP-IDF
+// heap hooks (CONFIG_HEAP_USE_HOOKS, enabled by no_heap: check_allocations).
+//
+// The hub arms it around its steady-state work in loop() and its scheduled
+// callbacks, so any malloc on those paths shows up in count(). Allocations
+// from other tasks (Bluedroid, WiFi, lwIP) are not counted. Without the
+// hooks, available() is false and count() stays at zero.
+class HeapGuard {
+ public:
+  // Stops counting for its lifetime, around work whose allocations are not
+  // the hub's own: ESPHome publishing entity state, user automations.
+  class Pause {
+   public:
+    Pause();
+    ~Pause();
+    Pause(const Pause &) = delete;
+    Pause &operator=(const Pause &) = delete;
+
+   protected:
+    void *task_{nullptr};
+  };
+
+  static bool available();
+
+  // Start counting allocations made by the calling task.
+  static void arm();
+  static void disarm();
+
+  // Allocations counted while armed so far, and the size of the last one.
+  static uint32_t count();
+  static size_t last_size();
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
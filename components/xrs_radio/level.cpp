@@ -0,0 +1,42 @@
+#include "level.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+static constexpr int COARSE_STEP = 25;
+
+uint8_t LevelTracker::update(int value) {
+  if (value < 0)
+    value = 0;
+  if (value > 100)
+    value = 100;
+
+  if (!this->has_value_) {
+    this->has_value_ = true;
+    this->level_ = value;
+    this->coarse_ = (value + COARSE_STEP / 2) / COARSE_STEP * COARSE_STEP;
+    return CHANGED_LEVEL | CHANGED_COARSE;
+  }
+
+  uint8_t changed = CHANGED_NONE;
+  const int delta = value > this->level_ ? value - this->level_ : this->level_ - value;
+  const bool at_end = (value == 0 || value == 100) && value != this->level_;
+  if ((delta > 0 && delta >= this->hysteresis_) || at_end) {
+    this->level_ = value;
+    changed |= CHANGED_LEVEL;
+  }
+
+  // Boundaries sit halfway between levels, widened by the hysteresis in the
+  // direction away from the current level. Work in half points.
+  const int twice = value * 2;
+  const int up = (this->coarse_ * 2) + COARSE_STEP + this->hysteresis_ * 2;
+  const int down = (this->coarse_ * 2) - COARSE_STEP - this->hysteresis_ * 2;
+  if ((this->coarse_ < 100 && twice >= up) || (this->coarse_ > 0 && twice <= down)) {
+    this->coarse_ = (value + COARSE_STEP / 2) / COARSE_STEP * COARSE_STEP;
+    changed |= CHANGED_COARSE;
+  }
+  return changed;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Quantises the radio's periodic 0-100 level report (protocol.md 5.3).
+//
+// The fine value is only republished once it moves `hysteresis` points
+// away from the last published value (or reaches 0/100). The coarse level
+// (0/25/50/75/100) only changes once the value is `hysteresis` points past
+// the midpoint between two levels, so a signal hovering on a boundary
+// does not flip back and forth.
+class LevelTracker {
+ public:
+  enum Change : uint8_t {
+    CHANGED_NONE = 0,
+    CHANGED_LEVEL = 1 << 0,
+    CHANGED_COARSE = 1 << 1,
+  };
+
+  void set_hysteresis(uint8_t points) { this->hysteresis_ = points; }
+
+  // Feed one sample (clamped to 0-100); returns which outputs changed.
+  uint8_t update(int value);
+
+  bool has_value() const { return this->has_value_; }
+  uint8_t level() const { return this->level_; }
+  uint8_t coarse() const { return this->coarse_; }
+
+  void reset() { this->has_value_ = false; }
+
+ protected:
+  uint8_t hysteresis_{3};
+  bool has_value_{false};
+  uint8_t level_{0};
+  uint8_t coarse_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
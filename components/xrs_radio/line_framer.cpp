@@ -0,0 +1,96 @@
+#include "line_framer.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+static bool is_alpha(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+
+static bool is_at(const std::string &s, size_t pos) {
+  return (s[pos] == 'A' || s[pos] == 'a') && (s[pos + 1] == 'T' || s[pos + 1] == 't');
+}
+
+void LineFramer::reserve(size_t bytes) {
+  this->buffer_.reserve(bytes);
+  this->line_.reserve(bytes);
+}
+
+void LineFramer::reset() {
+  this->buffer_.clear();
+  this->in_quotes_ = false;
+  this->discarding_ = false;
+}
+
+// Two characters after '+' that start a notification or reply the hub
+// knows: +WG..., +WH..., +GM..., +GS..., +GO..., +S1...
+static bool is_known_prefix(char a, char b) {
+  static const char *const PREFIXES[] = {"WG", "WH", "GM", "GS", "GO", "S1"};
+  for (const char *p : PREFIXES) {
+    if (p[0] == a && p[1] == b)
+      return true;
+  }
+  return false;
+}
+
+size_t LineFramer::marker_keep_(char c) const {
+  const size_t size = this->buffer_.size();
+  if (this->in_quotes_ || size < 2)
+    return 0;
+  // "...AT+": an echo glued to the previous line; keep "AT".
+  if (c == '+')
+    return size >= 3 && is_at(this->buffer_, size - 2) && !is_alpha(this->buffer_[size - 3]) ? 2 : 0;
+  // "...+W" right after a closing quote: whatever it is, the quoted field
+  // ended the previous line; keep "+".
+  if (c >= 'A' && c <= 'Z' && this->buffer_[size - 1] == '+')
+    return this->buffer_[size - 2] == '"' ? 1 : 0;
+  // "...+WG": a known prefix glued to the previous line; keep "+W", or
+  // "AT+W" when it is an echo. Not a marker when it starts the line.
+  if (this->buffer_[size - 2] == '+' && is_known_prefix(this->buffer_[size - 1], c)) {
+    const size_t plus = size - 2;
+    if (plus >= 2 && is_at(this->buffer_, plus - 2))
+      return plus == 2 ? 0 : 4;
+    return plus == 0 ? 0 : 2;
+  }
+  return 0;
+}
+
+void LineFramer::feed(const char *data, size_t len, const LineFn &on_line) {
+  for (size_t i = 0; i < len; i++) {
+    const char c = data[i];
+    if (c == '\r')
+      continue;
+    if (c == '\n') {
+      if (this->discarding_) {
+        this->discarding_ = false;
+        continue;
+      }
+      if (this->buffer_.empty())
+        continue;
+      this->line_.swap(this->buffer_);
+      this->buffer_.clear();
+      this->in_quotes_ = false;
+      on_line(this->line_);
+      continue;
+    }
+    if (this->discarding_)
+      continue;
+
+    const size_t keep = this->marker_keep_(c);
+    if (keep != 0) {
+      this->buffer_.erase(0, this->buffer_.size() - keep);
+      this->resyncs_++;
+    }
+    if (this->max_length_ != 0 && this->buffer_.size() >= this->max_length_) {
+      this->buffer_.clear();
+      this->in_quotes_ = false;
+      this->discarding_ = true;
+      this->overflows_++;
+      continue;
+    }
+    if (c == '"')
+      this->in_quotes_ = !this->in_quotes_;
+    this->buffer_.push_back(c);
+  }
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
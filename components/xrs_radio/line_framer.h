@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Splits the SPP byte stream into lines (protocol.md 3.2).
+//
+// Lines end at LF; CR is ignored. A message-start marker in the middle of
+// a line also starts a new one, outside double quotes: a '+' and one of the
+// notification prefixes the hub knows ("+WG", "+GM", "+S1"...), possibly as
+// part of an "AT+" echo ("OKAT+GMI?"); "AT+" after a character that is not
+// a letter; or '+' and an upper-case letter right after a closing quote.
+// The partial line before the marker is dropped (it lost its line end and
+// may be cut short) and counted as a resync.
+//
+// This is a trade-off: a '+' inside unquoted text ("CB+UHF") is left alone
+// unless a known prefix follows it, so a glued line with an unknown prefix
+// is not split, while valid text holding "+WG" and the like still is.
+//
+// A line growing past the maximum length is dropped up to its line end and
+// counted as an overflow.
+class LineFramer {
+ public:
+  using LineFn = std::function<void(const std::string &line)>;
+
+  // Longest line kept (0 = unlimited).
+  void set_max_length(size_t max_length) { this->max_length_ = max_length; }
+  size_t max_length() const { return this->max_length_; }
+  // Allocate the line buffers up front.
+  void reserve(size_t bytes);
+
+  // Frame `len` bytes, calling `on_line` for each complete non-empty line.
+  void feed(const char *data, size_t len, const LineFn &on_line);
+
+  // Drop any partial line, e.g. after reconnecting.
+  void reset();
+
+  uint32_t resyncs() const { return this->resyncs_; }
+  uint32_t overflows() const { return this->overflows_; }
+
+ protected:
+  // If `c` completes a marker started by the last buffered characters, how
+  // many of those start the new line; 0 if it does not.
+  size_t marker_keep_(char c) const;
+
+  std::string buffer_;
+  // The complete line being handed out; swapped with buffer_ so both keep
+  // their capacity.
+  std::string line_;
+  size_t max_length_{0};
+  bool in_quotes_{false};
+  // Dropping the rest of an over-long line.
+  bool discarding_{false};
+  uint32_t resyncs_{0};
+  uint32_t overflows_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,93 @@
+#include "line_matcher.h"
+
+namespace esphome {
+namespace xrs_radio {
+
+size_t LineMatcher::match(const std::string &line, const MatchFn &on_match) const {
+  if (this->count_ == 0)
+    return 0;
+
+  size_t matched = 0;
+  Field fields[MAX_FIELDS];
+  uint16_t node = 0;
+  size_t pos = 0;
+  while (true) {
+    const Node &n = this->nodes_[node];
+    for (uint16_t t = 0; t < n.term_count; t++) {
+      const uint16_t index = this->terms_[n.first_term + t];
+      uint8_t count = 0;
+      if (glob_(this->patterns_[index].rest, line, pos, fields, count)) {
+        on_match(index, fields, count);
+        matched++;
+      }
+    }
+    if (pos == line.size() || n.child_count == 0)
+      break;
+
+    const uint8_t c = static_cast<uint8_t>(line[pos]);
+    uint16_t next = NONE;
+    for (uint16_t i = 0; i < n.child_count; i++) {
+      const uint8_t child = this->nodes_[n.first_child + i].c;
+      if (child == c) {
+        next = n.first_child + i;
+        break;
+      }
+      if (child > c)
+        break;
+    }
+    if (next == NONE)
+      break;
+    node = next;
+    pos++;
+  }
+  return matched;
+}
+
+bool LineMatcher::glob_(const char *pattern, const std::string &line, size_t pos, Field *fields, uint8_t &count) {
+  const char *p = pattern;
+  size_t s = pos;
+  // Backtrack point: the last '*' seen and where its field currently ends.
+  const char *star = nullptr;
+  size_t star_end = 0;
+  uint8_t star_field = 0;
+  count = 0;
+
+  while (s < line.size()) {
+    if (*p == '*') {
+      star_field = count;
+      if (count < MAX_FIELDS)
+        fields[count] = {static_cast<uint16_t>(s), 0};
+      count++;
+      star = ++p;
+      star_end = s;
+      continue;
+    }
+    if (*p != '\0' && (*p == '?' || *p == line[s])) {
+      p++;
+      s++;
+      continue;
+    }
+    if (star == nullptr)
+      return false;
+    // Let the last '*' take one more character and retry what follows it.
+    star_end++;
+    if (star_field < MAX_FIELDS)
+      fields[star_field].len = static_cast<uint16_t>(star_end - fields[star_field].start);
+    count = star_field + 1;
+    p = star;
+    s = star_end;
+  }
+
+  while (*p == '*') {
+    if (count < MAX_FIELDS)
+      fields[count] = {static_cast<uint16_t>(s), 0};
+    count++;
+    p++;
+  }
+  if (count > MAX_FIELDS)
+    count = MAX_FIELDS;
+  return *p == '\0';
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Matcher for the hub's on_line: patterns, compiled by the Python codegen.
+//
+// Patterns are globs: '*' matches any run of characters and becomes a
+// field, '?' matches one character, everything else is literal, so a
+// plain prefix is written "+WGALERT:*". The literal text in front of each
+// pattern's first wildcard is merged into a prefix trie, emitted as flat
+// const tables. A line is walked down the trie once; only patterns whose
+// literal prefix it carries are then checked, from the end of that prefix.
+//
+// A '*' matches as little as it can, except the last one in a pattern,
+// which takes whatever the rest of the pattern leaves over.
+class LineMatcher {
+ public:
+  static constexpr uint16_t NONE = 0xFFFF;
+  static constexpr uint8_t MAX_FIELDS = 8;
+
+  // Trie node. The children of a node are consecutive, sorted by `c`;
+  // terms[first_term..] lists the patterns whose literal prefix ends here.
+  struct Node {
+    uint8_t c;
+    uint16_t first_child;
+    uint16_t child_count;
+    uint16_t first_term;
+    uint16_t term_count;
+  };
+
+  // Pattern with its literal prefix (already matched by the trie) removed.
+  struct Pattern {
+    const char *rest;
+  };
+
+  // Byte range of a '*' field within the line.
+  struct Field {
+    uint16_t start;
+    uint16_t len;
+  };
+
+  // Called for each matching pattern (in trie order: shorter prefixes first).
+  using MatchFn = std::function<void(uint16_t pattern, const Field *fields, uint8_t count)>;
+
+  void configure(const Node *nodes, const uint16_t *terms, const Pattern *patterns, uint16_t count) {
+    this->nodes_ = nodes;
+    this->terms_ = terms;
+    this->patterns_ = patterns;
+    this->count_ = count;
+  }
+
+  uint16_t size() const { return this->count_; }
+
+  // Run every pattern against `line`. Returns the number that matched.
+  size_t match(const std::string &line, const MatchFn &on_match) const;
+
+ protected:
+  // Glob `pattern` against line[pos..]; fills `fields` with '*' spans.
+  static bool glob_(const char *pattern, const std::string &line, size_t pos, Field *fields, uint8_t &count);
+
+  const Node *nodes_{nullptr};
+  const uint16_t *terms_{nullptr};
+  const Pattern *patterns_{nullptr};
+  uint16_t count_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
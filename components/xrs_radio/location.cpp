@@ -0,0 +1,190 @@
+#include "location.h"
+
+#include <cmath>
+
+namespace esphome {
+namespace xrs_radio {
+
+static constexpr double EARTH_RADIUS_M = 6371000.0;
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+// A turn only counts once the new leg is this fraction of min_distance long,
+// otherwise GPS jitter around a stationary point reads as heading changes.
+static constexpr double TURN_MIN_LEG_FRACTION = 0.25;
+
+double haversine_m(double lat1, double lon1, double lat2, double lon2) {
+  const double dlat = (lat2 - lat1) * DEG_TO_RAD;
+  const double dlon = (lon2 - lon1) * DEG_TO_RAD;
+  const double a = std::sin(dlat / 2) * std::sin(dlat / 2) +
+                   std::cos(lat1 * DEG_TO_RAD) * std::cos(lat2 * DEG_TO_RAD) *
+                       std::sin(dlon / 2) * std::sin(dlon / 2);
+  return 2.0 * EARTH_RADIUS_M * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+}
+
+double bearing_deg(double lat1, double lon1, double lat2, double lon2) {
+  const double phi1 = lat1 * DEG_TO_RAD;
+  const double phi2 = lat2 * DEG_TO_RAD;
+  const double dlon = (lon2 - lon1) * DEG_TO_RAD;
+  const double y = std::sin(dlon) * std::cos(phi2);
+  const double x = std::cos(phi1) * std::sin(phi2) -
+                   std::sin(phi1) * std::cos(phi2) * std::cos(dlon);
+  double deg = std::atan2(y, x) * RAD_TO_DEG;
+  if (deg < 0.0)
+    deg += 360.0;
+  return deg;
+}
+
+double heading_delta_deg(double a, double b) {
+  double d = std::fmod(std::fabs(a - b), 360.0);
+  return d > 180.0 ? 360.0 - d : d;
+}
+
+void LocationGate::set_intervals(uint32_t min_ms, uint32_t base_ms, uint32_t max_ms) {
+  // An explicitly short keep-alive wins over the default rate limit.
+  this->min_interval_ms_ = min_ms < base_ms ? min_ms : base_ms;
+  this->base_interval_ms_ = base_ms;
+  this->max_interval_ms_ = max_ms < base_ms ? base_ms : max_ms;
+  this->stationary_interval_ms_ = this->base_interval_ms_;
+}
+
+void LocationGate::reset() {
+  this->has_sent_ = false;
+  this->has_heading_ = false;
+  this->stationary_interval_ms_ = this->base_interval_ms_;
+}
+
+bool LocationGate::is_movement_(double lat, double lon) const {
+  if (lat == this->sent_lat_ && lon == this->sent_lon_)
+    return false;
+
+  const double dist = haversine_m(this->sent_lat_, this->sent_lon_, lat, lon);
+  if (dist >= this->min_distance_m_)
+    return true;
+
+  if (this->has_heading_ && this->heading_change_deg_ > 0.0f &&
+      dist >= this->min_distance_m_ * TURN_MIN_LEG_FRACTION) {
+    const double heading = bearing_deg(this->sent_lat_, this->sent_lon_, lat, lon);
+    if (heading_delta_deg(heading, this->heading_) >= this->heading_change_deg_)
+      return true;
+  }
+  return false;
+}
+
+bool LocationGate::should_send(uint32_t now, double lat, double lon) const {
+  if (!this->has_sent_)
+    return true;
+
+  const uint32_t since = now - this->sent_at_;
+  if (since < this->min_interval_ms_)
+    return false;
+  if (this->is_movement_(lat, lon))
+    return true;
+  return since >= this->stationary_interval_ms_;
+}
+
+void LocationGate::mark_sent(uint32_t now, double lat, double lon) {
+  if (this->has_sent_) {
+    if (this->is_movement_(lat, lon)) {
+      this->heading_ = bearing_deg(this->sent_lat_, this->sent_lon_, lat, lon);
+      this->has_heading_ = true;
+      this->stationary_interval_ms_ = this->base_interval_ms_;
+    } else {
+      // Keep-alive for a stationary unit: back off.
+      uint32_t next = this->stationary_interval_ms_ * 2;
+      if (next > this->max_interval_ms_ || next < this->stationary_interval_ms_)
+        next = this->max_interval_ms_;
+      this->stationary_interval_ms_ = next;
+    }
+  }
+
+  this->has_sent_ = true;
+  this->sent_lat_ = lat;
+  this->sent_lon_ = lon;
+  this->sent_at_ = now;
+}
+
+void LocationFilter::set_smoothing(float alpha) {
+  if (alpha < 0.05f)
+    alpha = 0.05f;
+  if (alpha > 1.0f)
+    alpha = 1.0f;
+  this->alpha_ = alpha;
+  // Critically damped beta for the chosen alpha.
+  this->beta_ = 2.0f * (2.0f - alpha) - 4.0f * std::sqrt(1.0f - alpha);
+}
+
+void LocationFilter::reset() {
+  this->has_fix_ = false;
+  this->consecutive_rejects_ = 0;
+}
+
+void LocationFilter::seed_(uint32_t now, double lat, double lon) {
+  this->has_fix_ = true;
+  this->lat_ = lat;
+  this->lon_ = lon;
+  this->vel_n_ = 0.0;
+  this->vel_e_ = 0.0;
+  this->last_update_ = now;
+  this->consecutive_rejects_ = 0;
+}
+
+bool LocationFilter::update(uint32_t now, double lat, double lon) {
+  if (std::isnan(lat) || std::isnan(lon) || lat < -90.0 || lat > 90.0 ||
+      lon < -180.0 || lon > 180.0) {
+    this->rejected_++;
+    return false;
+  }
+  if (!this->has_fix_) {
+    this->seed_(now, lat, lon);
+    return true;
+  }
+
+  double dt = (now - this->last_update_) / 1000.0;
+  if (dt < 0.001)
+    dt = 0.001;
+
+  // Measurement relative to the current estimate, in metres.
+  const double m_per_deg = EARTH_RADIUS_M * DEG_TO_RAD;
+  const double cos_lat = std::cos(this->lat_ * DEG_TO_RAD);
+  const double meas_n = (lat - this->lat_) * m_per_deg;
+  const double meas_e = (lon - this->lon_) * m_per_deg * cos_lat;
+
+  if (std::sqrt(meas_n * meas_n + meas_e * meas_e) / dt > this->max_speed_mps_) {
+    this->rejected_++;
+    if (++this->consecutive_rejects_ < MAX_CONSECUTIVE_REJECTS)
+      return false;
+    this->seed_(now, lat, lon);
+    return true;
+  }
+  this->consecutive_rejects_ = 0;
+
+  const double pred_n = this->vel_n_ * dt;
+  const double pred_e = this->vel_e_ * dt;
+  const double res_n = meas_n - pred_n;
+  const double res_e = meas_e - pred_e;
+
+  const double pos_n = pred_n + this->alpha_ * res_n;
+  const double pos_e = pred_e + this->alpha_ * res_e;
+  this->vel_n_ += this->beta_ * res_n / dt;
+  this->vel_e_ += this->beta_ * res_e / dt;
+
+  const double speed = std::sqrt(this->vel_n_ * this->vel_n_ + this->vel_e_ * this->vel_e_);
+  if (speed > this->max_speed_mps_) {
+    this->vel_n_ *= this->max_speed_mps_ / speed;
+    this->vel_e_ *= this->max_speed_mps_ / speed;
+  }
+
+  this->lat_ += pos_n / m_per_deg;
+  if (cos_lat > 1e-6)
+    this->lon_ += pos_e / (m_per_deg * cos_lat);
+  if (this->lon_ > 180.0)
+    this->lon_ -= 360.0;
+  else if (this->lon_ < -180.0)
+    this->lon_ += 360.0;
+  this->last_update_ = now;
+  return true;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
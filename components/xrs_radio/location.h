@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Great-circle distance between two WGS84 points, in metres.
+double haversine_m(double lat1, double lon1, double lat2, double lon2);
+
+// Initial bearing from point 1 to point 2, in degrees [0, 360).
+double bearing_deg(double lat1, double lon1, double lat2, double lon2);
+
+// Smallest absolute difference between two headings, in degrees [0, 180].
+double heading_delta_deg(double a, double b);
+
+// Decides when a position fix is worth an AT+WGTLOC upload.
+//
+// A fix is uploaded when the unit has moved at least min_distance from the
+// last uploaded fix, or has turned by at least heading_change, but never more
+// often than min_interval. While stationary, the last position is re-sent as
+// a keep-alive starting at base_interval and doubling up to max_interval.
+// A fix identical to the last uploaded one never counts as movement.
+class LocationGate {
+ public:
+  void set_min_distance(float metres) { this->min_distance_m_ = metres; }
+  void set_heading_change(float degrees) { this->heading_change_deg_ = degrees; }
+  void set_intervals(uint32_t min_ms, uint32_t base_ms, uint32_t max_ms);
+
+  uint32_t min_interval() const { return this->min_interval_ms_; }
+  float min_distance() const { return this->min_distance_m_; }
+  float heading_change() const { return this->heading_change_deg_; }
+  uint32_t base_interval() const { return this->base_interval_ms_; }
+  uint32_t max_interval() const { return this->max_interval_ms_; }
+
+  // Forget the last uploaded fix so the next valid one is sent immediately.
+  void reset();
+
+  // Return true if the fix at `now` should be uploaded. Call mark_sent()
+  // once it actually went out.
+  bool should_send(uint32_t now, double lat, double lon) const;
+
+  // Record an uploaded fix and update the stationary back-off.
+  void mark_sent(uint32_t now, double lat, double lon);
+
+ protected:
+  // Whether the fix moved/turned enough to count as movement.
+  bool is_movement_(double lat, double lon) const;
+
+  float min_distance_m_{100.0f};
+  float heading_change_deg_{30.0f};
+  uint32_t min_interval_ms_{30000};
+  uint32_t base_interval_ms_{60000};
+  uint32_t max_interval_ms_{600000};
+
+  bool has_sent_{false};
+  double sent_lat_{0.0};
+  double sent_lon_{0.0};
+  uint32_t sent_at_{0};
+  // Heading of the last uploaded leg; valid once two fixes have been sent.
+  double heading_{0.0};
+  bool has_heading_{false};
+  uint32_t stationary_interval_ms_{60000};
+};
+
+// Smooths raw GPS fixes and rejects implausible jumps before they reach the
+// upload gate.
+//
+// Fixes are tracked with a constant-velocity alpha-beta filter (the steady
+// state of a constant-velocity Kalman filter) in a local east/north frame.
+// A fix implying a speed above max_speed is discarded as an outlier; after
+// MAX_CONSECUTIVE_REJECTS in a row the filter assumes the unit genuinely
+// moved (e.g. after a tunnel) and re-seeds from the new fix.
+class LocationFilter {
+ public:
+  static constexpr uint8_t MAX_CONSECUTIVE_REJECTS = 5;
+
+  void set_max_speed(float metres_per_second) { this->max_speed_mps_ = metres_per_second; }
+  // 1.0 passes fixes through unsmoothed; smaller values smooth harder.
+  void set_smoothing(float alpha);
+
+  float max_speed() const { return this->max_speed_mps_; }
+  float smoothing() const { return this->alpha_; }
+
+  // Feed one raw fix taken at `now`. Returns false if it was rejected.
+  bool update(uint32_t now, double lat, double lon);
+
+  // Drop the current estimate; the next fix seeds the filter.
+  void reset();
+
+  bool has_fix() const { return this->has_fix_; }
+  double lat() const { return this->lat_; }
+  double lon() const { return this->lon_; }
+  uint32_t rejected() const { return this->rejected_; }
+
+ protected:
+  void seed_(uint32_t now, double lat, double lon);
+
+  float max_speed_mps_{70.0f};
+  float alpha_{0.5f};
+  float beta_{0.17f};
+
+  bool has_fix_{false};
+  double lat_{0.0};
+  double lon_{0.0};
+  // Velocity estimate, metres per second north/east.
+  double vel_n_{0.0};
+  double vel_e_{0.0};
+  uint32_t last_update_{0};
+  uint8_t consecutive_rejects_{0};
+  uint32_t rejected_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
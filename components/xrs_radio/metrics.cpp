@@ -0,0 +1,92 @@
+#include "metrics.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace xrs_radio {
+
+void LatencyWindow::add(uint32_t sample) {
+  this->samples_[this->head_] = sample;
+  this->head_ = (this->head_ + 1) % CAPACITY;
+  if (this->count_ < CAPACITY)
+    this->count_++;
+}
+
+bool LatencyWindow::percentiles(uint32_t &p50, uint32_t &p99) const {
+  if (this->count_ == 0)
+    return false;
+
+  // Work on a stack copy so the ring keeps its insertion order.
+  uint32_t sorted[CAPACITY];
+  std::copy(this->samples_, this->samples_ + this->count_, sorted);
+
+  const size_t i50 = (this->count_ - 1) * 50 / 100;
+  const size_t i99 = (this->count_ - 1) * 99 / 100;
+  std::nth_element(sorted, sorted + i99, sorted + this->count_);
+  p99 = sorted[i99];
+  std::nth_element(sorted, sorted + i50, sorted + i99);
+  p50 = sorted[i50];
+  return true;
+}
+
+uint32_t CommandTracker::hash_(const char *data, size_t len) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    h ^= static_cast<uint8_t>(data[i]);
+    h *= 16777619u;
+  }
+  return h;
+}
+
+void CommandTracker::on_sent(uint32_t now, const char *cmd, size_t len, bool keep) {
+  if (this->count_ == CAPACITY) {
+    // Oldest command never got a result; forget it.
+    this->head_ = (this->head_ + 1) % CAPACITY;
+    this->count_--;
+  }
+  this->entries_[(this->head_ + this->count_) % CAPACITY] = {now, hash_(cmd, len), false, keep};
+  this->count_++;
+}
+
+bool CommandTracker::on_echo(uint32_t now, const char *line, size_t len, uint32_t &latency_ms) {
+  const uint32_t h = hash_(line, len);
+  for (size_t i = 0; i < this->count_; i++) {
+    Entry &e = this->entries_[(this->head_ + i) % CAPACITY];
+    if (e.echoed || e.hash != h)
+      continue;
+    // Echoes arrive in send order: earlier ones still missing are lost.
+    for (size_t j = 0; j < i; j++)
+      this->entries_[(this->head_ + j) % CAPACITY].echoed = true;
+    e.echoed = true;
+    latency_ms = now - e.sent_at;
+    return true;
+  }
+  return false;
+}
+
+bool CommandTracker::on_result(uint32_t now, uint32_t &rtt_ms, uint32_t &cmd_hash) {
+  this->expire(now);
+  if (this->count_ == 0)
+    return false;
+  rtt_ms = now - this->entries_[this->head_].sent_at;
+  cmd_hash = this->entries_[this->head_].hash;
+  this->head_ = (this->head_ + 1) % CAPACITY;
+  this->count_--;
+  return true;
+}
+
+void CommandTracker::expire(uint32_t now) {
+  while (this->count_ > 0 && !this->entries_[this->head_].kept &&
+         (now - this->entries_[this->head_].sent_at) > TIMEOUT_MS) {
+    this->head_ = (this->head_ + 1) % CAPACITY;
+    this->count_--;
+  }
+}
+
+void CommandTracker::release() {
+  for (size_t i = 0; i < this->count_; i++)
+    this->entries_[(this->head_ + i) % CAPACITY].kept = false;
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Fixed-size ring of latency samples (microseconds or milliseconds, caller's
+// choice) with percentile lookup. Never allocates; the oldest sample is
+// overwritten once the ring is full.
+class LatencyWindow {
+ public:
+  static constexpr size_t CAPACITY = 64;
+
+  // Record one sample.
+  void add(uint32_t sample);
+
+  // Compute the p50 and p99 of the samples currently held.
+  // Returns false (and leaves the outputs untouched) if the window is empty.
+  bool percentiles(uint32_t &p50, uint32_t &p99) const;
+
+  size_t size() const { return this->count_; }
+  void clear() {
+    this->head_ = 0;
+    this->count_ = 0;
+  }
+
+ protected:
+  uint32_t samples_[CAPACITY]{};
+  size_t head_{0};
+  size_t count_{0};
+};
+
+// Tracks commands written to the radio that have not yet been answered with a
+// final OK/ERROR result code, so the hub can report queue depth and RTT.
+// Results are matched to commands in FIFO order, which is how the radio
+// answers them. With echo on (ATE1) each command also comes back verbatim
+// first; echoes are matched by a hash of the command text, so the hub can
+// drop them early and time them as a write acknowledgement.
+class CommandTracker {
+ public:
+  static constexpr size_t CAPACITY = 16;
+  // Commands not answered within this window are assumed to have no final
+  // result code and are dropped so they cannot skew later RTT samples.
+  static constexpr uint32_t TIMEOUT_MS = 5000;
+
+  // Record that a command (without its CRLF) was written at `now`. A `keep`
+  // command is exempt from expiry, for one whose result comes only after a
+  // long reply (a channel table dump); commands after it then wait for it.
+  void on_sent(uint32_t now, const char *cmd, size_t len, bool keep = false);
+
+  // If `line` is the echo of an outstanding command, mark it echoed, set
+  // `latency_ms` to its write-to-echo time and return true. Commands
+  // before it whose echo never came are skipped.
+  bool on_echo(uint32_t now, const char *line, size_t len, uint32_t &latency_ms);
+
+  // Record a final result code; on success `rtt_ms` holds the round trip of
+  // the oldest outstanding command, and `cmd_hash` its command_hash().
+  bool on_result(uint32_t now, uint32_t &rtt_ms, uint32_t &cmd_hash);
+
+  // Identifies a command (without its CRLF) in on_result().
+  static uint32_t command_hash(const char *cmd, size_t len) { return hash_(cmd, len); }
+
+  // Drop commands older than TIMEOUT_MS, up to the first kept one.
+  void expire(uint32_t now);
+  // Let kept commands expire again, e.g. once their result is given up on.
+  void release();
+
+  // Forget everything (e.g. on disconnect).
+  void clear() {
+    this->head_ = 0;
+    this->count_ = 0;
+  }
+
+  size_t depth() const { return this->count_; }
+
+ protected:
+  static uint32_t hash_(const char *data, size_t len);
+
+  struct Entry {
+    uint32_t sent_at;
+    uint32_t hash;
+    bool echoed;
+    bool kept;
+  };
+  Entry entries_[CAPACITY]{};
+  size_t head_{0};
+  size_t count_{0};
+};
+
+// Raw counters gathered on the hot path. XRSRadioComponent turns these into
+// rates and percentiles when it publishes its metric sensors.
+struct XRSMetrics {
+  uint32_t rx_bytes{0};
+  uint32_t rx_lines{0};
+  uint32_t publishes{0};
+  uint32_t reconnects{0};
+  uint32_t connects{0};
+  uint32_t last_rx_ms{0};
+  bool has_rx{false};
+
+  // Handler time per received line, in microseconds.
+  LatencyWindow parse_time_us;
+  // Command round trip (write → OK/ERROR) since the last publish, in ms.
+  uint32_t rtt_sum_ms{0};
+  uint32_t rtt_count{0};
+  // Write → echo time since the last publish, in ms.
+  uint32_t echo_sum_ms{0};
+  uint32_t echo_count{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -12,6 +12,8 @@ XRSRadioSelect = xrs_radio_ns.class_("XRSRadioSelect", select_base.Select, cg.Co
 XRS_RADIO_SELECT_TYPES = {
     "zone": XRSSelectType.XRS_SELECT_ZONE,
     "channel": XRSSelectType.XRS_SELECT_CHANNEL,
+    # Only the channels of the current zone; options follow zone changes.
+    "zone_channel": XRSSelectType.XRS_SELECT_ZONE_CHANNEL,
 }
 
 # New-style schema (ESPHome 2025.10+)
@@ -19,41 +19,48 @@ void XRSRadioSelect::dump_config() {
 
 void XRSRadioSelect::refresh_from_parent() {
   this->update_options_();
+  this->publish_current();
 }
 
-void XRSRadioSelect::update_options_() {
+void XRSRadioSelect::publish_current() {
   if (this->parent_ == nullptr)
     return;
 
-  std::vector<std::string> opts;
-  if (this->type_ == XRSSelectType::XRS_SELECT_ZONE) {
-    this->parent_->get_zone_options(opts);
-  } else {
-    this->parent_->get_channel_options(opts);
-  }
+  const int index = this->parent_->get_current_option_index(this->type_);
+  if (index < 0 || (index == this->published_index_ && this->has_state()))
+    return;
+  this->published_index_ = index;
+  this->publish_state(static_cast<size_t>(index));
+}
 
-  this->traits.set_options(opts);
+void XRSRadioSelect::update_options_() {
+  if (this->parent_ == nullptr)
+    return;
+
+  const uint32_t version = this->parent_->get_options_version(this->type_);
+  if (version == this->options_version_)
+    return;
+  this->options_version_ = version;
+  this->published_index_ = -1;
+  this->traits.set_options(this->parent_->get_options(this->type_));
 }
 
 void XRSRadioSelect::control(const std::string &value) {
   if (this->parent_ == nullptr)
     return;
 
+  auto index = this->index_of(value);
+  uint8_t zone = 0;
+  uint8_t ch = 0;
+  if (!index.has_value() || !this->parent_->get_option_zone_channel(this->type_, *index, zone, ch))
+    return;
+
+  // State follows the hub: published optimistically, rolled back if the
+  // radio does not confirm.
   if (this->type_ == XRSSelectType::XRS_SELECT_ZONE) {
-    // Expect values like "Zone 1"
-    unsigned zone = 0;
-    if (sscanf(value.c_str(), "Zone %u", &zone) == 1) {
-      this->parent_->set_zone(static_cast<uint8_t>(zone));
-      this->publish_state(value);
-    }
+    this->parent_->set_zone(zone);
   } else {
-    // Expect values like "Z1 / Ch 12"
-    unsigned zone = 0;
-    unsigned ch = 0;
-    if (sscanf(value.c_str(), "Z%u / Ch %u", &zone, &ch) == 2) {
-      this->parent_->set_channel(static_cast<uint8_t>(zone), static_cast<uint8_t>(ch));
-      this->publish_state(value);
-    }
+    this->parent_->set_channel(zone, ch);
   }
 }
 
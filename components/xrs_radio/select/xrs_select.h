@@ -20,15 +20,27 @@ class XRSRadioSelect : public select::Select, public Component {
   float get_setup_priority() const override { return setup_priority::DATA; }
 
   void refresh_from_parent();
+
+  // Publish the hub's current zone/channel, if it is one of the options.
+  void publish_current();
+  // Publish it even if unchanged, to undo an option picked in the frontend
+  // that the hub could not act on.
+  void republish_current() {
+    this->published_index_ = -1;
+    this->publish_current();
+  }
  protected:
   // Called when HA/user changes the selected option
   void control(const std::string &value) override;
 
-  // Internal: refresh traits.options from the hub’s channel/zone table
+  // Internal: refresh traits.options from the hub’s prebuilt option list
   void update_options_();
 
   XRSRadioComponent *parent_{nullptr};
   XRSSelectType type_{XRSSelectType::XRS_SELECT_ZONE};
+  // Hub option list version currently in traits, and the index last published.
+  uint32_t options_version_{0};
+  int published_index_{-1};
 };
 
 }  // namespace xrs_radio
@@ -4,7 +4,7 @@ import esphome.config_validation as cv
 from esphome.const import CONF_ID, CONF_TYPE
 from esphome.components import sensor as sensor_base
 
-from .. import XRSRadioComponent, XRSNumericSensorType, CONF_XRS_ID, xrs_radio_ns
+from .. import XRSRadioComponent, XRSNumericSensorType, CONF_XRS_ID, CONF_RANK, AIRTIME_RANK_SCHEMA, xrs_radio_ns
 
 XRSRadioSensor = xrs_radio_ns.class_("XRSRadioSensor", sensor_base.Sensor)
 
@@ -13,14 +13,34 @@ XRS_RADIO_SENSOR_TYPES = {
     "zone": XRSNumericSensorType.XRS_SENSOR_ZONE,
     "volume": XRSNumericSensorType.XRS_SENSOR_VOLUME,
     "ptt_timer": XRSNumericSensorType.XRS_SENSOR_PTT_TIMER,
+    "airtime_transmissions": XRSNumericSensorType.XRS_SENSOR_AIRTIME_TRANSMISSIONS,
+    "airtime_seconds": XRSNumericSensorType.XRS_SENSOR_AIRTIME_SECONDS,
+    "airtime_duty_1min": XRSNumericSensorType.XRS_SENSOR_AIRTIME_DUTY_1M,
+    "airtime_duty_15min": XRSNumericSensorType.XRS_SENSOR_AIRTIME_DUTY_15M,
+    "airtime_duty_1h": XRSNumericSensorType.XRS_SENSOR_AIRTIME_DUTY_1H,
+    "level": XRSNumericSensorType.XRS_SENSOR_LEVEL,
+    "level_coarse": XRSNumericSensorType.XRS_SENSOR_LEVEL_COARSE,
 }
 
-CONFIG_SCHEMA = sensor_base.sensor_schema(XRSRadioSensor).extend(
-    {
-        cv.GenerateID(): cv.declare_id(XRSRadioSensor),
-        cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
-        cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_SENSOR_TYPES, lower=True),
-    }
+
+def validate_rank(config):
+    if CONF_RANK in config and not config[CONF_TYPE].startswith("airtime_"):
+        raise cv.Invalid("'rank' is only valid with the airtime_* types")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    sensor_base.sensor_schema(XRSRadioSensor).extend(
+        {
+            cv.GenerateID(): cv.declare_id(XRSRadioSensor),
+            cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
+            cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_SENSOR_TYPES, lower=True),
+
+            # For airtime_* types: which channel to report, 1 (default) = busiest
+            cv.Optional(CONF_RANK): AIRTIME_RANK_SCHEMA,
+        }
+    ),
+    validate_rank,
 )
 
 
@@ -33,4 +53,6 @@ async def to_code(config):
 
     cg.add(var.set_parent(parent))
     cg.add(var.set_type(type_enum))
+    if CONF_RANK in config:
+        cg.add(var.set_rank(config[CONF_RANK]))
     cg.add(parent.register_numeric_sensor(type_enum, var))
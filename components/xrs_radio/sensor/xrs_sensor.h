@@ -13,9 +13,14 @@ class XRSRadioSensor : public sensor::Sensor {
   void set_parent(XRSRadioComponent *parent) { parent_ = parent; }
   void set_type(XRSNumericSensorType type) { type_ = type; }
 
+  // 1-based rank for busiest-channel airtime entities (1 = busiest).
+  void set_rank(uint8_t rank) { rank_ = rank; }
+  uint8_t get_rank() const { return rank_; }
+
  protected:
   XRSRadioComponent *parent_{nullptr};
   XRSNumericSensorType type_{XRS_SENSOR_CHANNEL};
+  uint8_t rank_{1};
 };
 
 }  // namespace xrs_radio
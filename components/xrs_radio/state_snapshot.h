@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Single-writer snapshot of a POD struct that any task can read without
+// locks and without ever seeing a half-written copy.
+//
+// Two buffers alternate: the writer fills the one readers are not being
+// pointed at, then publishes it by bumping version_. A reader copies the
+// published buffer and retries only if a publish happened meanwhile (the
+// writer may then be refilling the buffer it copied). Readers never wait
+// for the writer, so a reader preempting it cannot spin forever.
+template<typename T> class StateSnapshot {
+  static_assert(std::is_trivially_copyable<T>::value, "snapshot type must be POD");
+
+ public:
+  // Writer only. Publishes `value` unless it equals the current snapshot;
+  // returns whether it did.
+  bool write(const T &value) {
+    const uint32_t version = this->version_.load(std::memory_order_relaxed);
+    if (memcmp(&this->buffers_[version & 1], &value, sizeof(T)) == 0)
+      return false;
+    // A reader that sees any of these stores also sees the publish of
+    // `version`, and so knows to retry if it was copying this buffer.
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(&this->buffers_[(version + 1) & 1], &value, sizeof(T));
+    this->version_.store(version + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Any task.
+  T read() const {
+    T out;
+    uint32_t version;
+    do {
+      version = this->version_.load(std::memory_order_acquire);
+      memcpy(&out, &this->buffers_[version & 1], sizeof(T));
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while (this->version_.load(std::memory_order_relaxed) != version);
+    return out;
+  }
+
+  // Number of publishes so far; changes whenever read() would.
+  uint32_t version() const { return this->version_.load(std::memory_order_acquire); }
+
+ protected:
+  T buffers_[2]{};
+  std::atomic<uint32_t> version_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
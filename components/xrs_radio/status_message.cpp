@@ -0,0 +1,101 @@
+#include "status_message.h"
+
+#include <utility>
+
+namespace esphome {
+namespace xrs_radio {
+
+void StatusMessage::set_username(const std::string &username) {
+  this->username_ = username;
+  this->dirty_ = true;
+}
+
+void StatusMessage::set_template(std::vector<std::string> literals) {
+  if (literals.empty())
+    literals.emplace_back();
+  this->literals_ = std::move(literals);
+  this->inputs_.assign(this->literals_.size() - 1, std::string());
+  this->dirty_ = true;
+}
+
+void StatusMessage::set_rate(uint32_t interval_ms, uint8_t burst) {
+  this->interval_ms_ = interval_ms;
+  this->burst_ = burst == 0 ? 1 : burst;
+  this->tokens_ = this->burst_;
+}
+
+bool StatusMessage::set_input(size_t index, const std::string &text) {
+  if (index >= this->inputs_.size() || this->inputs_[index] == text)
+    return false;
+  this->inputs_[index] = text;
+  this->dirty_ = true;
+  return true;
+}
+
+const std::string &StatusMessage::payload() {
+  if (!this->dirty_)
+    return this->payload_;
+  this->payload_.clear();
+  this->payload_ += '@';
+  append_clean_(this->payload_, this->username_);
+  this->payload_ += '#';
+  for (size_t i = 0; i < this->literals_.size(); i++) {
+    append_clean_(this->payload_, this->literals_[i]);
+    if (i < this->inputs_.size())
+      append_clean_(this->payload_, this->inputs_[i]);
+  }
+  this->dirty_ = false;
+  return this->payload_;
+}
+
+void StatusMessage::mark_sent(uint32_t now) {
+  this->refill_(now);
+  if (this->tokens_ > 0)
+    this->tokens_--;
+  this->last_sent_ = this->payload();
+}
+
+bool StatusMessage::has_token(uint32_t now) {
+  this->refill_(now);
+  return this->tokens_ > 0;
+}
+
+uint32_t StatusMessage::ms_until_token(uint32_t now) const {
+  if (this->tokens_ > 0)
+    return 0;
+  const uint32_t elapsed = now - this->last_refill_;
+  return elapsed >= this->interval_ms_ ? 0 : this->interval_ms_ - elapsed;
+}
+
+void StatusMessage::refill_(uint32_t now) {
+  if (this->tokens_ >= this->burst_ || this->interval_ms_ == 0) {
+    this->tokens_ = this->burst_;
+    this->last_refill_ = now;
+    return;
+  }
+  const uint32_t earned = (now - this->last_refill_) / this->interval_ms_;
+  if (earned == 0)
+    return;
+  if (earned >= static_cast<uint32_t>(this->burst_ - this->tokens_)) {
+    this->tokens_ = this->burst_;
+    this->last_refill_ = now;
+  } else {
+    this->tokens_ += earned;
+    this->last_refill_ += earned * this->interval_ms_;
+  }
+}
+
+void StatusMessage::append_clean_(std::string &out, const std::string &text) {
+  // The payload is sent quoted on one line: keep quotes and line breaks out.
+  for (char c : text) {
+    if (c == '"')
+      out += '\'';
+    else if (c == '\r' || c == '\n')
+      out += ' ';
+    else
+      out += c;
+  }
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
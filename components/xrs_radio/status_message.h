@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace xrs_radio {
+
+// AT+WGTMSG="@<username>#<status>" payload built from a template.
+//
+// The template is a list of literal parts with one input slot between each
+// pair. Inputs are formatted by the caller as they change; only the changed
+// slot is stored, and the payload is reassembled on demand when any slot
+// (or the username) differs from what the last payload was built from.
+// Sending is gated on the payload actually differing from the last one
+// sent, and on a token bucket of `burst` sends refilled one per interval.
+class StatusMessage {
+ public:
+  void set_username(const std::string &username);
+  // `literals` has one more entry than there are inputs.
+  void set_template(std::vector<std::string> literals);
+  void set_rate(uint32_t interval_ms, uint8_t burst);
+
+  size_t input_count() const { return this->inputs_.size(); }
+  uint32_t interval_ms() const { return this->interval_ms_; }
+
+  // Store the formatted value of input `index`; false if it is unchanged.
+  bool set_input(size_t index, const std::string &text);
+
+  // The full "@user#status" payload (rebuilt only when inputs changed).
+  const std::string &payload();
+
+  // Whether payload() differs from the last payload marked sent.
+  bool pending() { return this->payload() != this->last_sent_; }
+  void mark_sent(uint32_t now);
+  // Forget the last payload sent, e.g. after the radio reconnected.
+  void reset_sent() { this->last_sent_.clear(); }
+
+  // Whether a send is allowed at `now`; ms until one is otherwise.
+  bool has_token(uint32_t now);
+  uint32_t ms_until_token(uint32_t now) const;
+
+ protected:
+  void refill_(uint32_t now);
+  static void append_clean_(std::string &out, const std::string &text);
+
+  std::string username_;
+  std::vector<std::string> literals_{std::string()};
+  std::vector<std::string> inputs_;
+  std::string payload_;
+  bool dirty_{true};
+  std::string last_sent_;
+
+  uint32_t interval_ms_{30000};
+  uint8_t burst_{2};
+  uint8_t tokens_{2};
+  uint32_t last_refill_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
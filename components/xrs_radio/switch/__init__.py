@@ -15,14 +15,28 @@ XRS_RADIO_SWITCH_TYPES = {
     "quiet_mode": XRSSwitchType.XRS_SWITCH_QUIET_MODE,
     "quiet_memory": XRSSwitchType.XRS_SWITCH_QUIET_MEMORY,
     "silent_memory": XRSSwitchType.XRS_SWITCH_SILENT_MEMORY,
+    "s109_bit": XRSSwitchType.XRS_SWITCH_S109_BIT,
 }
 
-CONFIG_SCHEMA = switch_base.switch_schema(XRSRadioSwitch).extend(
-    {
-        cv.GenerateID(): cv.declare_id(XRSRadioSwitch),
-        cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
-        cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_SWITCH_TYPES, lower=True),
-    }
+CONF_BIT = "bit"
+
+
+def validate_bit(config):
+    if (config[CONF_TYPE] == "s109_bit") != (CONF_BIT in config):
+        raise cv.Invalid("'bit' is required for, and only valid with, type s109_bit")
+    return config
+
+CONFIG_SCHEMA = cv.All(
+    switch_base.switch_schema(XRSRadioSwitch).extend(
+        {
+            cv.GenerateID(): cv.declare_id(XRSRadioSwitch),
+            cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
+            cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_SWITCH_TYPES, lower=True),
+            # ATS109 register bit (0 = least significant) for type s109_bit
+            cv.Optional(CONF_BIT): cv.int_range(min=0, max=31),
+        }
+    ),
+    validate_bit,
 )
 
 
@@ -35,4 +49,6 @@ async def to_code(config):
 
     cg.add(var.set_parent(parent))
     cg.add(var.set_type(type_enum))
+    if CONF_BIT in config:
+        cg.add(var.set_bit(config[CONF_BIT]))
     cg.add(parent.register_switch(type_enum, var))
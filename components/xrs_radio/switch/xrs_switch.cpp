@@ -27,6 +27,9 @@ void XRSRadioSwitch::write_state(bool state) {
     case XRS_SWITCH_SILENT_MEMORY:
       this->parent_->set_silent_memory(state);
       break;
+    case XRS_SWITCH_S109_BIT:
+      this->parent_->set_s109_bit(this->bit_, state);
+      break;
   }
 }
 
@@ -6,17 +6,22 @@
 namespace esphome {
 namespace xrs_radio {
 
-// Simple switch entity, used for location/scan/duplex/quiet/silent controls.
+// Simple switch entity, used for location/scan/duplex/quiet/silent controls
+// and ATS109 register bits.
 class XRSRadioSwitch : public switch_::Switch {
  public:
   void set_parent(XRSRadioComponent *parent) { parent_ = parent; }
   void set_type(XRSSwitchType type) { type_ = type; }
+  // Register bit for XRS_SWITCH_S109_BIT.
+  void set_bit(uint8_t bit) { bit_ = bit; }
+  uint8_t get_bit() const { return bit_; }
 
  protected:
   void write_state(bool state) override;
 
   XRSRadioComponent *parent_{nullptr};
   XRSSwitchType type_{XRS_SWITCH_LOCATION_MODE};
+  uint8_t bit_{0};
 };
 
 }  // namespace xrs_radio
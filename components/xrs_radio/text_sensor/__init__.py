@@ -4,7 +4,7 @@ import esphome.config_validation as cv
 from esphome.const import CONF_ID, CONF_TYPE
 from esphome.components import text_sensor as ts_base
 
-from .. import XRSRadioComponent, XRSTextSensorType, CONF_XRS_ID, xrs_radio_ns
+from .. import XRSRadioComponent, XRSTextSensorType, CONF_XRS_ID, CONF_RANK, AIRTIME_RANK_SCHEMA, xrs_radio_ns
 
 XRSRadioTextSensor = xrs_radio_ns.class_("XRSRadioTextSensor", ts_base.TextSensor)
 
@@ -17,14 +17,30 @@ XRS_RADIO_TEXT_TYPES = {
     "power_state": XRSTextSensorType.XRS_TEXT_POWER_STATE,
     "ptt_state": XRSTextSensorType.XRS_TEXT_PTT_STATE,
     "channel_label": XRSTextSensorType.XRS_TEXT_CHANNEL_LABEL,
+    "airtime_channel": XRSTextSensorType.XRS_TEXT_AIRTIME_CHANNEL,
+    "event_export": XRSTextSensorType.XRS_TEXT_EVENT_EXPORT,
+    "table_export": XRSTextSensorType.XRS_TEXT_TABLE_EXPORT,
 }
 
-CONFIG_SCHEMA = ts_base.text_sensor_schema(XRSRadioTextSensor).extend(
-    {
-        cv.GenerateID(): cv.declare_id(XRSRadioTextSensor),
-        cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
-        cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_TEXT_TYPES, lower=True),
-    }
+
+def validate_rank(config):
+    if CONF_RANK in config and not config[CONF_TYPE].startswith("airtime_"):
+        raise cv.Invalid("'rank' is only valid with the airtime_* types")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    ts_base.text_sensor_schema(XRSRadioTextSensor).extend(
+        {
+            cv.GenerateID(): cv.declare_id(XRSRadioTextSensor),
+            cv.GenerateID(CONF_XRS_ID): cv.use_id(XRSRadioComponent),
+            cv.Required(CONF_TYPE): cv.one_of(*XRS_RADIO_TEXT_TYPES, lower=True),
+
+            # For airtime_* types: which channel to report, 1 (default) = busiest
+            cv.Optional(CONF_RANK): AIRTIME_RANK_SCHEMA,
+        }
+    ),
+    validate_rank,
 )
 
 
@@ -37,4 +53,6 @@ async def to_code(config):
 
     cg.add(var.set_parent(parent))
     cg.add(var.set_type(type_enum))
+    if CONF_RANK in config:
+        cg.add(var.set_rank(config[CONF_RANK]))
     cg.add(parent.register_text_sensor(type_enum, var))
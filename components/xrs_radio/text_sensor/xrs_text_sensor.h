@@ -12,9 +12,14 @@ class XRSRadioTextSensor : public text_sensor::TextSensor {
   void set_parent(XRSRadioComponent *parent) { parent_ = parent; }
   void set_type(XRSTextSensorType type) { type_ = type; }
 
+  // 1-based rank for busiest-channel airtime entities (1 = busiest).
+  void set_rank(uint8_t rank) { rank_ = rank; }
+  uint8_t get_rank() const { return rank_; }
+
  protected:
   XRSRadioComponent *parent_{nullptr};
   XRSTextSensorType type_{XRS_TEXT_MANUFACTURER};
+  uint8_t rank_{1};
 };
 
 }  // namespace xrs_radio
@@ -0,0 +1,100 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+namespace esphome {
+namespace xrs_radio {
+
+TimerWheel::TimerWheel() { std::fill(this->slots_, this->slots_ + SLOTS, NONE); }
+
+void TimerWheel::sync_(uint32_t now) {
+  if (!this->synced_) {
+    this->last_now_ = now;
+    this->synced_ = true;
+  }
+  this->elapsed_ms_ += now - this->last_now_;
+  this->last_now_ = now;
+}
+
+void TimerWheel::link_(uint8_t id) {
+  Timer &t = this->timers_[id];
+  uint8_t &head = this->slots_[t.due_tick % SLOTS];
+  t.prev = NONE;
+  t.next = head;
+  if (head != NONE)
+    this->timers_[head].prev = id;
+  head = id;
+  t.armed = true;
+}
+
+void TimerWheel::unlink_(uint8_t id) {
+  Timer &t = this->timers_[id];
+  if (t.prev != NONE) {
+    this->timers_[t.prev].next = t.next;
+  } else {
+    this->slots_[t.due_tick % SLOTS] = t.next;
+  }
+  if (t.next != NONE)
+    this->timers_[t.next].prev = t.prev;
+  t.armed = false;
+}
+
+void TimerWheel::schedule(uint8_t id, uint32_t now, uint32_t delay_ms) {
+  if (id >= MAX_TIMERS)
+    return;
+  this->sync_(now);
+  if (this->timers_[id].armed)
+    this->unlink_(id);
+  const uint64_t due = (this->elapsed_ms_ + delay_ms + TICK_MS - 1) / TICK_MS;
+  // Ticks before next_tick_ are never visited again.
+  this->timers_[id].due_tick = std::max(static_cast<uint32_t>(due), this->next_tick_);
+  this->link_(id);
+}
+
+void TimerWheel::cancel(uint8_t id) {
+  if (id < MAX_TIMERS && this->timers_[id].armed)
+    this->unlink_(id);
+}
+
+void TimerWheel::advance(uint32_t now, const FireFn &fire) {
+  this->sync_(now);
+  const uint32_t target = static_cast<uint32_t>(this->elapsed_ms_ / TICK_MS);
+  if (target < this->next_tick_)
+    return;
+
+  // After a long idle stretch one lap covers every bucket.
+  const uint32_t steps = std::min<uint32_t>(target - this->next_tick_ + 1, SLOTS);
+  uint8_t due = 0;
+  for (uint32_t k = 0; k < steps; k++) {
+    for (uint8_t id = this->slots_[(this->next_tick_ + k) % SLOTS]; id != NONE; id = this->timers_[id].next) {
+      if (this->timers_[id].due_tick <= target)
+        due |= 1u << id;
+    }
+  }
+  this->next_tick_ = target + 1;
+
+  for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+    if (due & (1u << id))
+      this->unlink_(id);
+  }
+  for (uint8_t id = 0; id < MAX_TIMERS; id++) {
+    // Skip timers an earlier callback has already re-armed.
+    if ((due & (1u << id)) && !this->timers_[id].armed)
+      fire(id);
+  }
+}
+
+uint32_t TimerWheel::next_due_ms(uint32_t now) const {
+  const uint64_t elapsed = this->elapsed_ms_ + (this->synced_ ? now - this->last_now_ : 0);
+  uint64_t best = UINT64_MAX;
+  for (const Timer &t : this->timers_) {
+    if (!t.armed)
+      continue;
+    const uint64_t at = static_cast<uint64_t>(t.due_tick) * TICK_MS;
+    best = std::min(best, at > elapsed ? at - elapsed : 0);
+  }
+  return best >= UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(best);
+}
+
+}  // namespace xrs_radio
+}  // namespace esphome
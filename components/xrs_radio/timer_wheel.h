@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace esphome {
+namespace xrs_radio {
+
+// Small hashed timer wheel for the hub's periodic jobs (reconnect attempts,
+// location checks, active-mute keep-alives).
+//
+// Each job has a fixed id below MAX_TIMERS and is either armed with one
+// deadline or idle. Deadlines are rounded up to TICK_MS and hashed into
+// SLOTS buckets by tick, so advance() only visits the buckets for ticks
+// that elapsed since the last call, and a timer never fires early.
+// Time is tracked from millis() deltas, so the 49-day wrap is harmless.
+class TimerWheel {
+ public:
+  static constexpr uint8_t MAX_TIMERS = 8;
+  static constexpr uint8_t SLOTS = 32;
+  static constexpr uint32_t TICK_MS = 50;
+
+  using FireFn = std::function<void(uint8_t id)>;
+
+  TimerWheel();
+
+  // (Re)arm timer `id` to fire `delay_ms` after `now`.
+  void schedule(uint8_t id, uint32_t now, uint32_t delay_ms);
+  void cancel(uint8_t id);
+  bool is_armed(uint8_t id) const { return id < MAX_TIMERS && this->timers_[id].armed; }
+
+  // Fire (in id order) every timer due by `now`. A fired timer is idle
+  // again, so `fire` may re-arm it.
+  void advance(uint32_t now, const FireFn &fire);
+
+  // Milliseconds from `now` until the earliest armed timer is due (0 if
+  // overdue), or UINT32_MAX if none is armed.
+  uint32_t next_due_ms(uint32_t now) const;
+
+ protected:
+  static constexpr uint8_t NONE = 0xFF;
+
+  struct Timer {
+    uint32_t due_tick;
+    uint8_t prev;
+    uint8_t next;
+    bool armed;
+  };
+
+  void sync_(uint32_t now);
+  void link_(uint8_t id);
+  void unlink_(uint8_t id);
+
+  Timer timers_[MAX_TIMERS]{};
+  uint8_t slots_[SLOTS];
+  // Milliseconds since the first sync_, and the millis() value it was at.
+  uint64_t elapsed_ms_{0};
+  uint32_t last_now_{0};
+  bool synced_{false};
+  // First tick advance() has not processed yet.
+  uint32_t next_tick_{0};
+};
+
+}  // namespace xrs_radio
+}  // namespace esphome
@@ -1,7 +1,12 @@
 #include "xrs_radio.h"
 
+#include <algorithm>
+#include <cinttypes>
+
 #include "at_parser.h"
+#include "esp_heap_caps.h"
 #include "binary_sensor/xrs_binary_sensor.h"
+#include "heap_guard.h"
 #include "esphome/core/hal.h"
 #include "esphome/core/helpers.h"
 #include "esphome/core/log.h"
@@ -10,15 +15,28 @@
 #include "sensor/xrs_sensor.h"
 #include "switch/xrs_switch.h"
 #include "text_sensor/xrs_text_sensor.h"
+#if defined(USE_WIFI) || defined(USE_ETHERNET)
+#include "esphome/components/network/util.h"
+#endif
 
 namespace esphome {
 namespace xrs_radio {
 
 static const char* const TAG = "xrs_radio";
 
-XRSRadioComponent* XRSRadioComponent::instance_ = nullptr;
-
-XRSRadioComponent::XRSRadioComponent() {}
+XRSRadioComponent* XRSRadioComponent::radios_[XRSRadioComponent::MAX_RADIOS] = {};
+size_t XRSRadioComponent::radio_count_ = 0;
+bool XRSRadioComponent::bt_stack_initialized_ = false;
+uint32_t XRSRadioComponent::bt_started_at_ = 0;
+uint32_t XRSRadioComponent::bt_init_ms_ = 0;
+size_t XRSRadioComponent::bt_heap_before_ = 0;
+size_t XRSRadioComponent::bt_heap_after_ = 0;
+size_t XRSRadioComponent::bt_ble_released_ = 0;
+std::atomic<XRSRadioComponent*> XRSRadioComponent::connect_owner_{nullptr};
+
+XRSRadioComponent::XRSRadioComponent() {
+  if (radio_count_ < MAX_RADIOS) radios_[radio_count_++] = this;
+}
 
 static std::string trim_copy(const std::string& s) {
   size_t start = 0;
@@ -88,10 +106,61 @@ void XRSRadioComponent::set_location_sensors(sensor::Sensor* lat,
   this->longitude_sensor_ = lon;
 }
 
+void XRSRadioComponent::set_status_username(const std::string& username) {
+  this->status_message_.set_username(username);
+  this->status_enabled_ = true;
+}
+
+void XRSRadioComponent::add_status_sensor(sensor::Sensor* s,
+                                          int8_t accuracy_decimals) {
+  this->status_inputs_.push_back({s, nullptr, accuracy_decimals});
+}
+
+void XRSRadioComponent::add_status_text_sensor(text_sensor::TextSensor* s) {
+  this->status_inputs_.push_back({nullptr, s, 0});
+}
+
 void XRSRadioComponent::set_location_interval(uint32_t interval_ms) {
   this->location_interval_ms_ = interval_ms;
 }
 
+void XRSRadioComponent::set_location_min_interval(uint32_t interval_ms) {
+  this->location_min_interval_ms_ = interval_ms;
+}
+
+void XRSRadioComponent::set_location_max_interval(uint32_t interval_ms) {
+  this->location_max_interval_ms_ = interval_ms;
+}
+
+void XRSRadioComponent::set_location_min_distance(float metres) {
+  this->location_gate_.set_min_distance(metres);
+}
+
+void XRSRadioComponent::set_location_heading_change(float degrees) {
+  this->location_gate_.set_heading_change(degrees);
+}
+
+void XRSRadioComponent::set_location_max_speed(float metres_per_second) {
+  this->location_filter_.set_max_speed(metres_per_second);
+}
+
+void XRSRadioComponent::set_location_smoothing(float alpha) {
+  this->location_filter_.set_smoothing(alpha);
+}
+
+void XRSRadioComponent::set_airtime_update_interval(uint32_t interval_ms) {
+  this->airtime_update_interval_ms_ = interval_ms;
+}
+
+void XRSRadioComponent::set_metrics_interval(uint32_t interval_ms) {
+  this->metrics_interval_ms_ = interval_ms;
+}
+
+void XRSRadioComponent::register_metric_sensor(XRSMetricType type,
+                                               sensor::Sensor* s) {
+  this->metric_sensors_.push_back({type, s});
+}
+
 void XRSRadioComponent::register_numeric_sensor(XRSNumericSensorType type,
                                                 XRSRadioSensor* s) {
   this->numeric_sensors_.push_back({type, s});
@@ -108,6 +177,20 @@ void XRSRadioComponent::register_numeric_sensor(XRSNumericSensorType type,
     case XRS_SENSOR_PTT_TIMER:
       s->publish_state(this->ptt_timer_);
       break;
+    case XRS_SENSOR_AIRTIME_TRANSMISSIONS:
+    case XRS_SENSOR_AIRTIME_SECONDS:
+    case XRS_SENSOR_AIRTIME_DUTY_1M:
+    case XRS_SENSOR_AIRTIME_DUTY_15M:
+    case XRS_SENSOR_AIRTIME_DUTY_1H:
+      // Published periodically by publish_airtime_().
+      this->has_airtime_entities_ = true;
+      break;
+    case XRS_SENSOR_LEVEL:
+      if (this->level_.has_value()) s->publish_state(this->level_.level());
+      break;
+    case XRS_SENSOR_LEVEL_COARSE:
+      if (this->level_.has_value()) s->publish_state(this->level_.coarse());
+      break;
   }
 }
 
@@ -142,6 +225,9 @@ void XRSRadioComponent::register_binary_sensor(XRSBinarySensorType type,
     case XRS_BIN_QUIET_MODE:
       s->publish_state(this->quiet_mode_);
       break;
+    case XRS_BIN_READY:
+      s->publish_state(this->link_state_ == XRS_LINK_READY);
+      break;
   }
 }
 
@@ -164,48 +250,22 @@ void XRSRadioComponent::register_text_sensor(XRSTextSensorType type,
     case XRS_TEXT_LAST_MESSAGE:
       break;
     case XRS_TEXT_POWER_STATE: {
-      std::string txt;
-      switch (this->power_state_) {
-        case 0:
-          txt = "Booting";
-          break;
-        case 1:
-          txt = "Running";
-          break;
-        case 2:
-          txt = "Reset initiated";
-          break;
-        case 3:
-          txt = "Power down initiated";
-          break;
-        case 4:
-          txt = "Power down";
-          break;
-        case 5:
-          txt = "Low battery";
-          break;
-        default:
-          txt = "";
-          break;
-      }
-      if (!txt.empty()) s->publish_state(txt);
+      const char* txt = this->power_state_text_();
+      if (txt[0] != '\0') s->publish_state(txt);
       break;
     }
-    case XRS_TEXT_PTT_STATE: {
-      std::string txt;
-      if (!this->ptt_active_) {
-        txt = "Idle";
-      } else if (this->ptt_data_) {
-        txt = "Transmitting voice+data";
-      } else {
-        txt = "Transmitting voice";
-      }
-      s->publish_state(txt);
+    case XRS_TEXT_PTT_STATE:
+      s->publish_state(this->ptt_state_text_());
       break;
-    }
     case XRS_TEXT_CHANNEL_LABEL:
       this->publish_channel_label_();
       break;
+    case XRS_TEXT_AIRTIME_CHANNEL:
+      this->has_airtime_entities_ = true;
+      break;
+    case XRS_TEXT_EVENT_EXPORT:
+    case XRS_TEXT_TABLE_EXPORT:
+      break;
   }
 }
 
@@ -236,6 +296,90 @@ void XRSRadioComponent::register_switch(XRSSwitchType type,
     case XRS_SWITCH_SILENT_MEMORY:
       sw->publish_state(this->silent_memory_);
       break;
+    case XRS_SWITCH_S109_BIT:
+      // Published once the register has been read.
+      this->has_s109_switches_ = true;
+      break;
+  }
+}
+
+void XRSRadioComponent::set_s109_bit(uint8_t bit, bool state) {
+  if (bit >= 32) return;
+  const uint32_t mask = 1u << bit;
+  if (state) {
+    this->s109_set_mask_ |= mask;
+    this->s109_clear_mask_ &= ~mask;
+  } else {
+    this->s109_clear_mask_ |= mask;
+    this->s109_set_mask_ &= ~mask;
+  }
+  // Restarted by every flip, so a burst of toggles costs one write.
+  this->set_timeout("s109_write", S109_BATCH_MS, [this]() {
+    this->run_checked_(&XRSRadioComponent::flush_s109_);
+  });
+}
+
+void XRSRadioComponent::request_s109_() {
+  this->s109_known_ = false;
+  if (!this->has_s109_switches_) return;
+  this->s109_read_pending_ = true;
+  this->send_command_("ATS109?");
+  this->set_timeout("s109_read", S109_READ_TIMEOUT_MS, [this]() {
+    if (!this->s109_read_pending_) return;
+    this->s109_read_pending_ = false;
+    ESP_LOGW(TAG, "No ATS109 value from the radio; bit switches stay read-only");
+    // Never write flips on top of a guess.
+    this->s109_set_mask_ = 0;
+    this->s109_clear_mask_ = 0;
+    this->publish_s109_switches_();
+  });
+}
+
+bool XRSRadioComponent::handle_s109_line_(const std::string& line) {
+  // Plain S-register read: the value alone on a line ("+S109: n" accepted too).
+  const char* p = line.c_str();
+  if (strncmp(p, "+S109:", 6) == 0) p += 6;
+  while (*p == ' ') p++;
+  if (*p < '0' || *p > '9') return false;
+  char* end = nullptr;
+  const unsigned long value = std::strtoul(p, &end, 10);
+  if (*end != '\0') return false;
+
+  this->s109_read_pending_ = false;
+  this->cancel_timeout("s109_read");
+  this->s109_value_ = static_cast<uint32_t>(value);
+  this->s109_known_ = true;
+  ESP_LOGD(TAG, "ATS109 = %" PRIu32, this->s109_value_);
+  this->publish_s109_switches_();
+  if (this->s109_set_mask_ != 0 || this->s109_clear_mask_ != 0)
+    this->flush_s109_();
+  return true;
+}
+
+void XRSRadioComponent::flush_s109_() {
+  // Held until the register is known; the read flushes them when it lands.
+  if (!this->s109_known_ || !this->connected_) return;
+  const uint32_t value =
+      (this->s109_value_ & ~this->s109_clear_mask_) | this->s109_set_mask_;
+  this->s109_set_mask_ = 0;
+  this->s109_clear_mask_ = 0;
+  if (value != this->s109_value_) {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "ATS109=%" PRIu32, value);
+    this->send_command_(buf);
+    this->s109_value_ = value;
+  }
+  this->publish_s109_switches_();
+}
+
+void XRSRadioComponent::publish_s109_switches_() {
+  HeapGuard::Pause pause;
+  for (auto& p : this->switches_) {
+    if (p.first != XRS_SWITCH_S109_BIT) continue;
+    const uint8_t bit = p.second->get_bit();
+    p.second->publish_state(this->s109_known_ && bit < 32 &&
+                            (this->s109_value_ & (1u << bit)) != 0);
+    this->metrics_.publishes++;
   }
 }
 
@@ -255,23 +399,20 @@ void XRSRadioComponent::set_volume(float volume) {
   snprintf(buf, sizeof(buf), "AT+WGAV=%d", vol);
   this->send_command_(buf);
 
-  for (auto& p : this->numeric_sensors_) {
-    if (p.first == XRS_SENSOR_VOLUME)
-      p.second->publish_state(this->current_volume_);
-  }
-  for (auto& p : this->numbers_) {
-    if (p.first == XRS_NUMBER_VOLUME)
-      p.second->publish_state(this->current_volume_);
-  }
+  this->publish_numeric_(XRS_SENSOR_VOLUME, this->current_volume_);
+  this->publish_number_(XRS_NUMBER_VOLUME, this->current_volume_);
 }
 
 void XRSRadioComponent::set_location_mode(bool enabled) {
   this->location_mode_ = enabled;
   ESP_LOGI(TAG, "Location mode %s", enabled ? "enabled" : "disabled");
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_LOCATION_MODE)
-      p.second->publish_state(this->location_mode_);
+  if (enabled) {
+    this->timers_.schedule(TIMER_LOCATION, esphome::millis(), 0);
+  } else {
+    this->timers_.cancel(TIMER_LOCATION);
   }
+  this->enable_loop();
+  this->publish_switch_(XRS_SWITCH_LOCATION_MODE, this->location_mode_);
 }
 
 void XRSRadioComponent::set_scan_enabled(bool enabled) {
@@ -280,12 +421,8 @@ void XRSRadioComponent::set_scan_enabled(bool enabled) {
   snprintf(buf, sizeof(buf), "AT+WGSCAN=%d", enabled ? 1 : 0);
   this->send_command_(buf);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_SCANNING) p.second->publish_state(this->scanning_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_SCAN) p.second->publish_state(this->scanning_);
-  }
+  this->publish_binary_(XRS_BIN_SCANNING, this->scanning_);
+  this->publish_switch_(XRS_SWITCH_SCAN, this->scanning_);
 }
 
 void XRSRadioComponent::set_duplex_enabled(bool enabled) {
@@ -294,14 +431,8 @@ void XRSRadioComponent::set_duplex_enabled(bool enabled) {
   snprintf(buf, sizeof(buf), "AT+WGDUP=%d", enabled ? 1 : 0);
   this->send_command_(buf);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_DUPLEX_ENABLED)
-      p.second->publish_state(this->duplex_enabled_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_DUPLEX)
-      p.second->publish_state(this->duplex_enabled_);
-  }
+  this->publish_binary_(XRS_BIN_DUPLEX_ENABLED, this->duplex_enabled_);
+  this->publish_switch_(XRS_SWITCH_DUPLEX, this->duplex_enabled_);
 }
 
 void XRSRadioComponent::set_quiet_mode(bool enabled) {
@@ -310,14 +441,8 @@ void XRSRadioComponent::set_quiet_mode(bool enabled) {
   snprintf(buf, sizeof(buf), "AT+WGSSQ=%d", enabled ? 1 : 0);
   this->send_command_(buf);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_QUIET_MODE)
-      p.second->publish_state(this->quiet_mode_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_QUIET_MODE)
-      p.second->publish_state(this->quiet_mode_);
-  }
+  this->publish_binary_(XRS_BIN_QUIET_MODE, this->quiet_mode_);
+  this->publish_switch_(XRS_SWITCH_QUIET_MODE, this->quiet_mode_);
 }
 
 void XRSRadioComponent::set_quiet_memory(bool enabled) {
@@ -326,14 +451,8 @@ void XRSRadioComponent::set_quiet_memory(bool enabled) {
   snprintf(buf, sizeof(buf), "AT+WGSQM=%d", enabled ? 1 : 0);
   this->send_command_(buf);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_QUIET_MEMORY)
-      p.second->publish_state(this->quiet_memory_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_QUIET_MEMORY)
-      p.second->publish_state(this->quiet_memory_);
-  }
+  this->publish_binary_(XRS_BIN_QUIET_MEMORY, this->quiet_memory_);
+  this->publish_switch_(XRS_SWITCH_QUIET_MEMORY, this->quiet_memory_);
 }
 
 void XRSRadioComponent::set_silent_memory(bool enabled) {
@@ -342,14 +461,8 @@ void XRSRadioComponent::set_silent_memory(bool enabled) {
   snprintf(buf, sizeof(buf), "AT+WGCSM=%d", enabled ? 1 : 0);
   this->send_command_(buf);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_SILENT_MEMORY)
-      p.second->publish_state(this->silent_memory_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_SILENT_MEMORY)
-      p.second->publish_state(this->silent_memory_);
-  }
+  this->publish_binary_(XRS_BIN_SILENT_MEMORY, this->silent_memory_);
+  this->publish_switch_(XRS_SWITCH_SILENT_MEMORY, this->silent_memory_);
 }
 
 void XRSRadioComponent::set_target_zone(uint8_t zone) {
@@ -361,14 +474,11 @@ void XRSRadioComponent::set_target_zone(uint8_t zone) {
     ESP_LOGW(TAG, "Ignoring zone change while not connected");
     return;
   }
-
-  char buf[32];
-  snprintf(buf, sizeof(buf), "AT+WGZS=%u", zone);
-  this->send_command_(buf);
+  this->request_zone_channel_(zone, 0);
 }
 
 void XRSRadioComponent::set_target_zone_channel(uint8_t zone, uint8_t channel) {
-  if (zone < 1 || zone > 8 || channel < 1 || channel > 255) {
+  if (zone < 1 || zone > 8 || channel < 1) {
     ESP_LOGW(TAG, "Ignoring invalid zone/channel %u/%u", zone, channel);
     return;
   }
@@ -376,99 +486,621 @@ void XRSRadioComponent::set_target_zone_channel(uint8_t zone, uint8_t channel) {
     ESP_LOGW(TAG, "Ignoring zone/channel change while not connected");
     return;
   }
+  this->request_zone_channel_(zone, channel);
+}
 
-  char buf[40];
-  snprintf(buf, sizeof(buf), "AT+WGCHS=%u,%u", zone, channel);
-  this->send_command_(buf);
+void XRSRadioComponent::set_zone(uint8_t zone) { this->set_target_zone(zone); }
+
+void XRSRadioComponent::set_channel(uint8_t zone, uint8_t channel) {
+  this->set_target_zone_channel(zone, channel);
 }
 
-void XRSRadioComponent::set_zone(uint8_t zone) {
-  // Remember the requested zone locally
-  this->current_zone_ = zone;
+void XRSRadioComponent::request_zone_channel_(uint8_t zone, uint8_t channel) {
+  char buf[40];
+  if (channel == 0) {
+    snprintf(buf, sizeof(buf), "AT+WGZS=%u", zone);
+  } else {
+    snprintf(buf, sizeof(buf), "AT+WGCHS=%u,%u", zone, channel);
+  }
+  if (!this->send_command_(buf)) {
+    // Never asked, so never shown: the selects go straight back to the
+    // radio's zone/channel (or to a change already in flight).
+    ESP_LOGW(TAG, "Zone/channel change to Z%u/Ch%u not sent, staying on Z%d/Ch%d",
+             zone, channel, this->current_zone_, this->current_channel_);
+    for (auto& p : this->selects_) p.second->republish_current();
+    return;
+  }
 
-  // AT command: set working zone
-  // (If your spec uses a different command we can tweak this later.)
-  std::string cmd = str_sprintf("AT+WGCZ=%u", static_cast<unsigned>(zone));
-  this->send_command_(cmd);
+  this->change_pending_ = true;
+  this->pending_zone_ = zone;
+  this->pending_channel_ = channel;
+  this->apply_zone_channel_(zone, channel == 0 ? this->current_channel_ : channel);
+
+  // A newer request replaces the deadline of an older one; rollback always
+  // returns to what the radio last reported.
+  this->set_timeout("zone_channel_confirm", this->change_timeout_ms_,
+                    [this]() { this->rollback_zone_channel_(); });
 }
 
-void XRSRadioComponent::set_channel(uint8_t zone, uint8_t channel) {
-  // Remember the requested zone + channel locally
+void XRSRadioComponent::apply_zone_channel_(int zone, int channel) {
+  const bool zone_changed = zone != this->current_zone_;
+  const bool channel_changed = channel != this->current_channel_;
   this->current_zone_ = zone;
   this->current_channel_ = channel;
+  if (zone_changed) this->publish_numeric_(XRS_SENSOR_ZONE, this->current_zone_);
+  if (channel_changed)
+    this->publish_numeric_(XRS_SENSOR_CHANNEL, this->current_channel_);
+  this->publish_channel_label_();
+  // ESPHome copies select options and state; a zone change rebuilds the
+  // zone channel options as well.
+  HeapGuard::Pause pause;
+  if (zone_changed && this->has_select_(XRS_SELECT_ZONE_CHANNEL))
+    this->rebuild_zone_channel_options_();
+  for (auto& p : this->selects_) p.second->refresh_from_parent();
+}
 
-  // AT command: set working channel
-  // Adjust format if the XRS spec uses a different syntax.
-  std::string cmd = str_sprintf("AT+WGCH=%u,%u", static_cast<unsigned>(zone),
-                                static_cast<unsigned>(channel));
-  this->send_command_(cmd);
+void XRSRadioComponent::on_zone_channel_report_(int zone, int channel) {
+  const int new_channel = channel < 0 ? this->radio_channel_ : channel;
+  if (zone != this->radio_zone_ || new_channel != this->radio_channel_) {
+    XRSEvent* ev = this->record_event_(XRS_EVENT_CHANNEL_CHANGE);
+    if (ev != nullptr) {
+      ev->zone = static_cast<uint8_t>(zone);
+      ev->channel = static_cast<uint8_t>(new_channel);
+    }
+  }
+  this->radio_zone_ = zone;
+  this->radio_channel_ = new_channel;
+
+  if (this->change_pending_) {
+    const bool zone_only = this->pending_channel_ == 0;
+    if (zone == this->pending_zone_ &&
+        (zone_only || channel == this->pending_channel_)) {
+      ESP_LOGD(TAG, "Zone/channel change to Z%d/Ch%d confirmed", zone,
+               new_channel);
+      this->change_pending_ = false;
+      this->cancel_timeout("zone_channel_confirm");
+    } else if (channel < 0) {
+      // A bare zone report while a zone+channel change is pending; the
+      // +WGCHS: that settles it is still to come.
+      if (zone == this->pending_zone_) return;
+      ESP_LOGW(TAG, "Radio reported zone %d while Z%u/Ch%u was pending", zone,
+               this->pending_zone_, this->pending_channel_);
+      this->change_pending_ = false;
+      this->cancel_timeout("zone_channel_confirm");
+    } else {
+      ESP_LOGW(TAG, "Radio reported Z%d/Ch%d while Z%u/Ch%u was pending", zone,
+               channel, this->pending_zone_, this->pending_channel_);
+      this->change_pending_ = false;
+      this->cancel_timeout("zone_channel_confirm");
+    }
+  }
 
-  // Optionally update the friendly label text_sensor immediately
-  this->publish_channel_label_();
+  // The radio is authoritative for everything it reports.
+  this->apply_zone_channel_(this->radio_zone_, this->radio_channel_);
+}
+
+void XRSRadioComponent::rollback_zone_channel_() {
+  if (!this->change_pending_) return;
+  this->change_pending_ = false;
+  if (this->pending_channel_ == 0) {
+    ESP_LOGW(TAG,
+             "Rolling back zone change to %u: no +WHZS:/+WGCHS: confirmation "
+             "within %u ms, staying on Z%d/Ch%d",
+             this->pending_zone_, this->change_timeout_ms_, this->radio_zone_,
+             this->radio_channel_);
+  } else {
+    ESP_LOGW(TAG,
+             "Rolling back channel change to Z%u/Ch%u: no +WGCHS: confirmation "
+             "within %u ms, staying on Z%d/Ch%d",
+             this->pending_zone_, this->pending_channel_,
+             this->change_timeout_ms_, this->radio_zone_, this->radio_channel_);
+  }
+  this->apply_zone_channel_(this->radio_zone_, this->radio_channel_);
 }
 
 void XRSRadioComponent::setup() {
   ESP_LOGI(TAG, "Setting up XRSRadioComponent");
-  instance_ = this;
-  this->init_bluetooth_();
+  if (std::find(radios_, radios_ + radio_count_, this) == radios_ + radio_count_) {
+    ESP_LOGE(TAG, "At most %u radios are supported per node",
+             static_cast<unsigned>(MAX_RADIOS));
+    this->mark_failed();
+    return;
+  }
+  this->event_log_.init(this->event_history_size_);
+  this->allocate_buffers_();
+  this->rebuild_options_();
+  this->location_gate_.set_intervals(this->location_min_interval_ms_,
+                                     this->location_interval_ms_,
+                                     this->location_max_interval_ms_);
+  if (this->latitude_sensor_ != nullptr && this->longitude_sensor_ != nullptr) {
+    auto on_update = [this](float) {
+      this->defer("location_fix", [this]() {
+        this->run_checked_(&XRSRadioComponent::on_location_sensor_update_);
+      });
+    };
+    this->latitude_sensor_->add_on_state_callback(on_update);
+    this->longitude_sensor_->add_on_state_callback(on_update);
+  }
+  for (size_t i = 0; i < this->status_inputs_.size(); i++) {
+    const StatusInput& input = this->status_inputs_[i];
+    if (input.sensor != nullptr) {
+      const int8_t decimals = input.accuracy_decimals;
+      auto format = [decimals](float value) -> std::string {
+        if (std::isnan(value)) return "";
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+        return buf;
+      };
+      input.sensor->add_on_state_callback([this, i, format](float value) {
+        this->on_status_input_(i, format(value));
+      });
+      if (input.sensor->has_state())
+        this->status_message_.set_input(i, format(input.sensor->state));
+    } else if (input.text_sensor != nullptr) {
+      input.text_sensor->add_on_state_callback(
+          [this, i](std::string value) { this->on_status_input_(i, value); });
+      if (input.text_sensor->has_state())
+        this->status_message_.set_input(i, input.text_sensor->state);
+    }
+  }
+  if (this->call_sensor_ != nullptr) {
+    this->call_sensor_->add_on_state_callback(
+        [this](bool state) { this->on_call_state_(state); });
+    // Already in a call at boot: applied on connect like any other.
+    if (this->call_sensor_->has_state())
+      this->on_call_state_(this->call_sensor_->state);
+  }
+  this->schedule_bluetooth_start_();
+
+  if (this->has_airtime_entities_) {
+    this->set_interval("airtime", this->airtime_update_interval_ms_, [this]() {
+      this->run_checked_(&XRSRadioComponent::publish_airtime_);
+    });
+  }
+
+#ifdef USE_XRS_AT_BRIDGE
+  if (this->at_bridge_enabled_ && this->at_bridge_.start()) {
+    this->set_interval("at_bridge", AT_BRIDGE_POLL_MS, [this]() {
+      this->at_bridge_.poll(esphome::millis(),
+                            [this](uint8_t owner, const std::string& line) {
+                              return this->submit_bridge_command_(owner, line);
+                            });
+    });
+  }
+#endif
+
+  if (!this->metric_sensors_.empty()) {
+    this->last_metrics_publish_ = esphome::millis();
+    this->set_interval("metrics", this->metrics_interval_ms_, [this]() {
+      this->run_checked_(&XRSRadioComponent::publish_metrics_);
+    });
+  }
 }
 
 void XRSRadioComponent::loop() {
+  const bool checked = this->arm_heap_check_();
+
+  this->process_spp_events_();
+
   const uint32_t now = esphome::millis();
+  this->timers_.advance(now, [this, now](uint8_t id) { this->on_timer_(id, now); });
+
+  this->drain_tx_queue_();
+  // Catch changes that published nothing (e.g. no entity registered).
+  this->update_state_snapshot_();
+
+  this->check_heap_(checked);
+  if (this->is_failed()) return;
+
+  // Nothing left to do until the next deadline or SPP event: stop being
+  // called every main-loop tick. on_spp_event_ re-enables us from the
+  // Bluetooth task, the timeout below covers timed work.
+  const uint32_t wait = this->next_deadline_ms_(now);
+  if (wait == 0)
+    return;
+  this->disable_loop();
+  if (wait != UINT32_MAX) {
+    this->set_timeout("wake", wait, [this]() { this->enable_loop(); });
+  } else {
+    this->cancel_timeout("wake");
+  }
+}
 
-  if (this->bt_initialized_ && this->spp_ready_ && !this->connected_ &&
-      !this->connecting_ && !this->mac_address_.empty()) {
-    if (this->last_reconnect_attempt_ == 0 ||
-        (now - this->last_reconnect_attempt_) > this->reconnect_delay_ms_) {
+bool XRSRadioComponent::arm_heap_check_() {
+  // Steady state: connected, ready and not loading the channel table.
+  if (!this->no_heap_ || this->link_state_ != XRS_LINK_READY ||
+      this->channel_table_load_active_)
+    return false;
+  HeapGuard::arm();
+  return true;
+}
+
+void XRSRadioComponent::check_heap_(bool armed) {
+  if (!armed) return;
+  HeapGuard::disarm();
+  const uint32_t allocs = HeapGuard::count();
+  if (allocs == this->heap_allocs_seen_) return;
+  ESP_LOGE(TAG, "%" PRIu32 " heap allocation(s) in steady state (last %u bytes)",
+           allocs - this->heap_allocs_seen_,
+           static_cast<unsigned>(HeapGuard::last_size()));
+  this->heap_allocs_seen_ = allocs;
+  this->mark_failed();
+}
+
+void XRSRadioComponent::run_checked_(void (XRSRadioComponent::*fn)()) {
+  const bool checked = this->arm_heap_check_();
+  (this->*fn)();
+  this->check_heap_(checked);
+}
+
+void XRSRadioComponent::allocate_buffers_() {
+  this->tx_queue_.resize(this->tx_queue_max_);
+  if (!this->no_heap_) return;
+  for (auto& item : this->tx_queue_)
+    item.line.reserve(this->max_command_length_ + 2);
+  this->rx_pending_.reserve(this->rx_buffer_size_);
+  this->rx_work_.reserve(this->rx_buffer_size_);
+  this->framer_.reserve(this->framer_.max_length());
+  this->channel_table_.reserve(this->channel_table_size_);
+  // The longest text published through it: an export chunk.
+  this->text_scratch_.reserve(
+      std::max({16 + MAX_LABEL_LENGTH, TABLE_EXPORT_CHUNK_BYTES,
+                sizeof(this->export_buf_)}));
+  this->zone_options_.reserve(MAX_ZONES);
+  this->zone_option_keys_.reserve(MAX_ZONES);
+  if (this->has_select_(XRS_SELECT_CHANNEL)) {
+    this->channel_options_.reserve(this->channel_table_size_);
+    this->channel_option_keys_.reserve(this->channel_table_size_);
+  }
+  if (this->has_select_(XRS_SELECT_ZONE_CHANNEL)) {
+    this->zone_channel_options_.reserve(DEFAULT_CHANNELS);
+    this->zone_channel_option_keys_.reserve(DEFAULT_CHANNELS);
+  }
+}
+
+uint32_t XRSRadioComponent::next_deadline_ms_(uint32_t now) const {
+  if (this->tx_count_ != 0 && !this->tx_congested_)
+    return 0;
+  return this->timers_.next_due_ms(now);
+}
+
+void XRSRadioComponent::on_timer_(uint8_t id, uint32_t now) {
+  switch (id) {
+    case TIMER_RECONNECT:
+      if (!this->bt_initialized_ || !this->spp_ready_ || this->connected_ ||
+          this->connecting_ || this->mac_address_.empty())
+        return;
+      // Not our turn: release_connect_turn_() re-arms us when it is.
+      if (!this->may_start_connection_(now)) return;
       this->last_reconnect_attempt_ = now;
       this->start_connection_();
-
       this->reconnect_delay_ms_ *= 2;
       if (this->reconnect_delay_ms_ > RECONNECT_DELAY_MAX_MS)
         this->reconnect_delay_ms_ = RECONNECT_DELAY_MAX_MS;
-    }
+      // An attempt that failed to start is retried after the backoff; one
+      // in progress re-arms us when it opens, closes or times out.
+      if (!this->connecting_) this->schedule_reconnect_();
+      return;
+
+    case TIMER_LOCATION:
+      this->check_location_(now);
+      return;
+
+    case TIMER_ACTIVE_MUTE:
+      if (!this->connected_ || !this->call_active_) return;
+      this->send_active_mute_(2);
+      this->timers_.schedule(TIMER_ACTIVE_MUTE, now,
+                             this->active_mute_interval_ms_);
+      return;
+
+    default:
+      return;
   }
+}
 
-  if (this->connected_ && this->location_mode_ &&
-      this->latitude_sensor_ != nullptr && this->longitude_sensor_ != nullptr) {
-    if (this->latitude_sensor_->has_state() &&
-        this->longitude_sensor_->has_state()) {
-      const float lat = this->latitude_sensor_->state;
-      const float lon = this->longitude_sensor_->state;
-      if (!std::isnan(lat) && !std::isnan(lon)) {
-        if ((now - this->last_location_sent_) >= this->location_interval_ms_) {
-          this->send_location_update_();
-          this->last_location_sent_ = now;
-        }
-      }
-    }
+void XRSRadioComponent::schedule_reconnect_() {
+  if (!this->bt_initialized_ || !this->spp_ready_ || this->connected_ ||
+      this->connecting_ || this->mac_address_.empty())
+    return;
+  const uint32_t now = esphome::millis();
+  uint32_t delay = 0;
+  if (this->last_reconnect_attempt_ != 0) {
+    const uint32_t since = now - this->last_reconnect_attempt_;
+    delay = since > this->reconnect_delay_ms_
+                ? 0
+                : this->reconnect_delay_ms_ - since + 1;
+  }
+  this->timers_.schedule(TIMER_RECONNECT, now, delay);
+  this->enable_loop();
+}
+
+void XRSRadioComponent::check_location_(uint32_t now) {
+  // Re-armed by the next connect or set_location_mode(true).
+  if (!this->connected_ || !this->location_mode_ ||
+      this->latitude_sensor_ == nullptr || this->longitude_sensor_ == nullptr)
+    return;
+
+  // Fixes are filtered as they arrive; here we only decide whether the
+  // current estimate is worth uploading.
+  if (!this->location_filter_.has_fix()) {
+    this->timers_.schedule(TIMER_LOCATION, now, LOCATION_RETRY_MS);
+    return;
+  }
+  const double lat = this->location_filter_.lat();
+  const double lon = this->location_filter_.lon();
+  if (this->location_gate_.should_send(now, lat, lon)) {
+    this->send_location_update_(lat, lon);
+    this->location_gate_.mark_sent(now, lat, lon);
+  }
+  this->timers_.schedule(TIMER_LOCATION, now,
+                         this->location_gate_.min_interval());
+}
+
+void XRSRadioComponent::on_call_state_(bool active) {
+  if (active != this->call_active_)
+    ESP_LOGI(TAG, "Call %s", active ? "started" : "ended");
+  this->call_active_ = active;
+  if (!this->connected_) return;  // Applied again on connect.
+
+  if (active) {
+    this->send_active_mute_(0);
+    this->timers_.schedule(TIMER_ACTIVE_MUTE, esphome::millis(),
+                           this->active_mute_interval_ms_);
+    this->enable_loop();
+  } else {
+    this->timers_.cancel(TIMER_ACTIVE_MUTE);
+    if (this->active_mute_engaged_) this->send_active_mute_(1);
   }
 }
 
+void XRSRadioComponent::send_active_mute_(uint8_t mode) {
+  char buf[16];
+  snprintf(buf, sizeof(buf), "AT+WGACTM=%u", mode);
+  this->send_command_(buf);
+  this->active_mute_engaged_ = mode != 1;
+}
+
 void XRSRadioComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "XRS Radio:");
   ESP_LOGCONFIG(TAG, "  MAC Address: %s", this->mac_address_.c_str());
   ESP_LOGCONFIG(TAG, "  BT initialized: %s", YESNO(this->bt_initialized_));
+  ESP_LOGCONFIG(TAG, "  BT controller: %s%s",
+                this->bt_classic_only_ ? "Classic only" : "default mode",
+                this->bt_release_ble_memory_ ? ", BLE memory released" : "");
+  if (this->bt_wait_network_ || this->bt_start_delay_ms_ != 0) {
+    ESP_LOGCONFIG(TAG, "  BT start: %s, then %u ms",
+                  this->bt_wait_network_ ? "after network" : "at setup",
+                  this->bt_start_delay_ms_);
+  }
+  if (bt_stack_initialized_) {
+    ESP_LOGCONFIG(TAG,
+                  "  BT started: %u ms after boot, took %u ms, free heap %u "
+                  "-> %u bytes (%u from BLE release)",
+                  bt_started_at_, bt_init_ms_,
+                  static_cast<unsigned>(bt_heap_before_),
+                  static_cast<unsigned>(bt_heap_after_),
+                  static_cast<unsigned>(bt_ble_released_));
+  }
   ESP_LOGCONFIG(TAG, "  SPP ready: %s", YESNO(this->spp_ready_));
   ESP_LOGCONFIG(TAG, "  Connected: %s", YESNO(this->connected_));
+  if (this->link_state_ == XRS_LINK_READY) {
+    ESP_LOGCONFIG(TAG, "  Ready: %u ms after connecting", this->time_to_ready_ms_);
+  }
+  ESP_LOGCONFIG(TAG, "  Radios on this node: %u",
+                static_cast<unsigned>(radio_count_));
+  if (this->no_heap_) {
+    ESP_LOGCONFIG(TAG,
+                  "  No-heap mode: %u byte RX buffers, %u byte lines, %u "
+                  "commands of %u bytes, %u table rows",
+                  this->rx_buffer_size_,
+                  static_cast<unsigned>(this->framer_.max_length()),
+                  static_cast<unsigned>(this->tx_queue_max_),
+                  this->max_command_length_, this->channel_table_size_);
+    ESP_LOGCONFIG(TAG, "  Allocation check: %s",
+                  HeapGuard::available() ? "on" : "unavailable");
+  }
+#ifdef USE_XRS_AT_BRIDGE
+  if (this->at_bridge_enabled_) {
+    ESP_LOGCONFIG(TAG, "  AT bridge: port %u, %u clients, %u byte buffers",
+                  this->at_bridge_.port(), this->at_bridge_.max_clients(),
+                  this->at_bridge_.buffer_size());
+  }
+#endif
   ESP_LOGCONFIG(TAG, "  Location mode: %s", YESNO(this->location_mode_));
-  ESP_LOGCONFIG(TAG, "  Location interval: %u ms", this->location_interval_ms_);
+  ESP_LOGCONFIG(TAG, "  Location interval: %u ms (min %u ms, max %u ms)",
+                this->location_interval_ms_, this->location_gate_.min_interval(),
+                this->location_gate_.max_interval());
+  ESP_LOGCONFIG(TAG, "  Location min distance: %.0f m, heading change: %.0f deg",
+                this->location_gate_.min_distance(),
+                this->location_gate_.heading_change());
+  ESP_LOGCONFIG(TAG, "  Location max speed: %.1f m/s, smoothing: %.2f",
+                this->location_filter_.max_speed(),
+                this->location_filter_.smoothing());
+#ifdef USE_TIME
+  ESP_LOGCONFIG(TAG, "  Location time source: %s", YESNO(this->time_ != nullptr));
+#endif
+  ESP_LOGCONFIG(TAG, "  Zone/channel change timeout: %u ms",
+                this->change_timeout_ms_);
+  ESP_LOGCONFIG(TAG, "  Event history: %u entries",
+                static_cast<unsigned>(this->event_log_.capacity()));
+  if (this->call_sensor_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Active mute keep-alive: every %u ms",
+                  this->active_mute_interval_ms_);
+  }
+  if (this->status_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Status message: %u inputs, at most one per %u ms",
+                  static_cast<unsigned>(this->status_inputs_.size()),
+                  this->status_message_.interval_ms());
+  }
+  if (this->has_airtime_entities_) {
+    ESP_LOGCONFIG(TAG, "  Airtime update interval: %u ms",
+                  this->airtime_update_interval_ms_);
+  }
+  if (!this->metric_sensors_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Metrics: %u sensors, every %u ms",
+                  static_cast<unsigned>(this->metric_sensors_.size()),
+                  this->metrics_interval_ms_);
+    for (auto& p : this->metric_sensors_) {
+      LOG_SENSOR("    ", "Metric", p.second);
+    }
+  }
+}
+
+void XRSRadioComponent::publish_metrics_() {
+  const uint32_t now = esphome::millis();
+  const uint32_t elapsed_ms = now - this->last_metrics_publish_;
+  const float elapsed_s = elapsed_ms > 0 ? elapsed_ms / 1000.0f : 1.0f;
+  this->last_metrics_publish_ = now;
+
+  const uint32_t rx_bytes = this->metrics_.rx_bytes;
+  const uint32_t rx_lines = this->metrics_.rx_lines;
+  const uint32_t publishes = this->metrics_.publishes;
+  const float rx_bytes_rate = (rx_bytes - this->last_rx_bytes_) / elapsed_s;
+  const float lines_rate = (rx_lines - this->last_rx_lines_) / elapsed_s;
+  const float publish_rate = (publishes - this->last_publishes_) / elapsed_s;
+  this->last_rx_bytes_ = rx_bytes;
+  this->last_rx_lines_ = rx_lines;
+  this->last_publishes_ = publishes;
+
+  uint32_t p50 = 0;
+  uint32_t p99 = 0;
+  const bool have_parse = this->metrics_.parse_time_us.percentiles(p50, p99);
+  this->metrics_.parse_time_us.clear();
+
+  float rtt = NAN;
+  if (this->metrics_.rtt_count > 0)
+    rtt = static_cast<float>(this->metrics_.rtt_sum_ms) / this->metrics_.rtt_count;
+  this->metrics_.rtt_sum_ms = 0;
+  this->metrics_.rtt_count = 0;
+
+  float echo = NAN;
+  if (this->metrics_.echo_count > 0)
+    echo = static_cast<float>(this->metrics_.echo_sum_ms) / this->metrics_.echo_count;
+  this->metrics_.echo_sum_ms = 0;
+  this->metrics_.echo_count = 0;
+
+  this->commands_.expire(now);
+
+  HeapGuard::Pause pause;
+  for (auto& p : this->metric_sensors_) {
+    switch (p.first) {
+      case XRS_METRIC_RX_BYTES_RATE:
+        p.second->publish_state(rx_bytes_rate);
+        break;
+      case XRS_METRIC_LINES_RATE:
+        p.second->publish_state(lines_rate);
+        break;
+      case XRS_METRIC_PARSE_TIME_P50:
+        if (have_parse) p.second->publish_state(p50);
+        break;
+      case XRS_METRIC_PARSE_TIME_P99:
+        if (have_parse) p.second->publish_state(p99);
+        break;
+      case XRS_METRIC_TX_QUEUE_DEPTH:
+        p.second->publish_state(this->commands_.depth() + this->tx_count_);
+        break;
+      case XRS_METRIC_COMMAND_RTT:
+        if (!std::isnan(rtt)) p.second->publish_state(rtt);
+        break;
+      case XRS_METRIC_PUBLISH_RATE:
+        p.second->publish_state(publish_rate);
+        break;
+      case XRS_METRIC_RECONNECT_COUNT:
+        p.second->publish_state(this->metrics_.reconnects);
+        break;
+      case XRS_METRIC_TIME_SINCE_LAST_RX:
+        if (this->metrics_.has_rx)
+          p.second->publish_state((now - this->metrics_.last_rx_ms) / 1000.0f);
+        break;
+      case XRS_METRIC_CHANNEL_TABLE_HEAP:
+        p.second->publish_state(this->channel_table_heap_bytes_());
+        break;
+      case XRS_METRIC_ECHO_LATENCY:
+        if (!std::isnan(echo)) p.second->publish_state(echo);
+        break;
+      case XRS_METRIC_TIME_TO_READY:
+        // Published when the link becomes ready.
+        break;
+      case XRS_METRIC_RX_RESYNCS:
+        p.second->publish_state(this->framer_.resyncs());
+        break;
+      case XRS_METRIC_RX_OVERFLOWS:
+        p.second->publish_state(this->framer_.overflows());
+        break;
+    }
+  }
 }
 
+size_t XRSRadioComponent::channel_table_heap_bytes_() const {
+  // Labels live inside the rows.
+  return this->channel_table_.capacity() * sizeof(ChannelInfo);
+}
+
+
+static bool network_is_up() {
+#if defined(USE_WIFI) || defined(USE_ETHERNET)
+  return network::is_connected();
+#else
+  return true;
+#endif
+}
+
+void XRSRadioComponent::schedule_bluetooth_start_() {
+  if (!this->bt_wait_network_) {
+    this->start_bluetooth_after_delay_();
+    return;
+  }
+  const uint32_t waiting_since = esphome::millis();
+  this->set_interval("bt_start", BT_START_POLL_MS, [this, waiting_since]() {
+    const bool up = network_is_up();
+    if (!up && esphome::millis() - waiting_since < this->bt_network_timeout_ms_)
+      return;
+    if (!up) {
+      ESP_LOGW(TAG, "No network after %u ms, starting Bluetooth anyway",
+               this->bt_network_timeout_ms_);
+    }
+    this->cancel_interval("bt_start");
+    this->start_bluetooth_after_delay_();
+  });
+}
+
+void XRSRadioComponent::start_bluetooth_after_delay_() {
+  if (this->bt_start_delay_ms_ == 0) {
+    this->init_bluetooth_();
+    return;
+  }
+  this->set_timeout("bt_start_delay", this->bt_start_delay_ms_,
+                    [this]() { this->init_bluetooth_(); });
+}
 
 void XRSRadioComponent::init_bluetooth_() {
   if (this->bt_initialized_)
     return;
+  if (bt_stack_initialized_) {
+    // Another radio already brought the stack up; ESP_SPP_INIT_EVT is
+    // delivered to every registered radio.
+    this->bt_initialized_ = true;
+    return;
+  }
 
   esp_err_t ret;
-
-  // Optional: free BLE memory if you never use BLE
-  // ret = esp_bt_controller_mem_release(ESP_BT_MODE_BLE);
-  // if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
-  //   ESP_LOGW(TAG, "esp_bt_controller_mem_release(BLE) failed: %d", ret);
-  // }
+  const uint32_t started = esphome::millis();
+  const size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+  // BLE controller memory can only be released before the controller is
+  // initialised, and only if the controller never runs BLE.
+  if (this->bt_release_ble_memory_) {
+    ret = esp_bt_controller_mem_release(ESP_BT_MODE_BLE);
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+      ESP_LOGW(TAG, "esp_bt_controller_mem_release(BLE) failed: %d", ret);
+    } else {
+      const size_t after = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+      bt_ble_released_ = after > heap_before ? after - heap_before : 0;
+    }
+  }
 
   esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+  if (this->bt_classic_only_) bt_cfg.mode = ESP_BT_MODE_CLASSIC_BT;
   ESP_LOGI(TAG, "BT controller init, cfg.mode=0x%02X",
            static_cast<unsigned>(bt_cfg.mode));
 
@@ -515,8 +1147,17 @@ void XRSRadioComponent::init_bluetooth_() {
     return;
   }
 
+  bt_stack_initialized_ = true;
   this->bt_initialized_ = true;
-  ESP_LOGI(TAG, "Bluetooth Classic and SPP initialized");
+  bt_started_at_ = esphome::millis();
+  bt_init_ms_ = bt_started_at_ - started;
+  bt_heap_before_ = heap_before;
+  bt_heap_after_ = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  ESP_LOGI(TAG,
+           "Bluetooth Classic and SPP initialized %u ms after boot (took %u "
+           "ms), free heap %u -> %u bytes",
+           bt_started_at_, bt_init_ms_, static_cast<unsigned>(bt_heap_before_),
+           static_cast<unsigned>(bt_heap_after_));
 }
 
 bool XRSRadioComponent::parse_mac_address_(esp_bd_addr_t out) {
@@ -556,6 +1197,7 @@ void XRSRadioComponent::start_connection_() {
 
   ESP_LOGI(TAG, "Connecting to XRS radio at %s", this->mac_address_.c_str());
 
+  connect_owner_.store(this);
   esp_err_t ret = esp_spp_connect(
       ESP_SPP_SEC_NONE,   // no extra security
       ESP_SPP_ROLE_MASTER,
@@ -567,10 +1209,53 @@ void XRSRadioComponent::start_connection_() {
     ESP_LOGE(TAG, "esp_spp_connect failed: %d", static_cast<int>(ret));
     // leave reconnect/backoff to the main loop – it will retry based on
     // last_reconnect_attempt_ and reconnect_delay_ms_
+    this->release_connect_turn_();
     return;
   }
 
   this->connecting_ = true;
+  this->set_link_state_(XRS_LINK_CONNECTING);
+  // Don't let a connect that never reports back block the other radios.
+  this->set_timeout("connect_timeout", CONNECT_TIMEOUT_MS, [this]() {
+    if (!this->connecting_) return;
+    ESP_LOGW(TAG, "Connect to %s timed out", this->mac_address_.c_str());
+    this->connecting_ = false;
+    this->set_link_state_(XRS_LINK_DOWN);
+    this->release_connect_turn_();
+    this->schedule_reconnect_();
+  });
+}
+
+bool XRSRadioComponent::may_start_connection_(uint32_t now) {
+  if (this->connect_waiting_since_ == 0)
+    this->connect_waiting_since_ = now != 0 ? now : 1;
+  if (connect_owner_.load() != nullptr) return false;
+
+  // Oldest waiter goes first; ties go to the radio registered first.
+  bool before_me = true;
+  for (size_t i = 0; i < radio_count_; i++) {
+    const XRSRadioComponent* other = radios_[i];
+    if (other == this) {
+      before_me = false;
+      continue;
+    }
+    if (other->connect_waiting_since_ == 0) continue;
+    const int32_t d = static_cast<int32_t>(other->connect_waiting_since_ -
+                                           this->connect_waiting_since_);
+    if (d < 0 || (d == 0 && before_me)) return false;
+  }
+  this->connect_waiting_since_ = 0;
+  return true;
+}
+
+void XRSRadioComponent::release_connect_turn_() {
+  XRSRadioComponent* self = this;
+  if (!connect_owner_.compare_exchange_strong(self, nullptr)) return;
+  this->cancel_timeout("connect_timeout");
+  for (size_t i = 0; i < radio_count_; i++) {
+    if (radios_[i]->connect_waiting_since_ != 0)
+      radios_[i]->schedule_reconnect_();
+  }
 }
 
 
@@ -581,292 +1266,504 @@ void XRSRadioComponent::close_connection_() {
   }
 }
 
-void XRSRadioComponent::send_command_(const std::string& cmd) {
+bool XRSRadioComponent::send_command_(const char* cmd, size_t len,
+                                      uint8_t owner) {
+  std::string* line = this->claim_tx_slot_(cmd, len, len, owner);
+  if (line == nullptr) return false;
+  line->append(cmd, len);
+  this->commit_tx_slot_(line);
+  return true;
+}
+
+std::string* XRSRadioComponent::claim_tx_slot_(const char* cmd, size_t cmd_len,
+                                               size_t len, uint8_t owner) {
+  const int shown = static_cast<int>(cmd_len);
   if (!this->connected_ || this->spp_handle_ == 0) {
-    ESP_LOGW(TAG, "Cannot send command, not connected: '%s'", cmd.c_str());
+    ESP_LOGW(TAG, "Cannot send command, not connected: '%.*s'", shown, cmd);
+    return nullptr;
+  }
+  if (this->tx_count_ >= this->tx_queue_.size()) {
+    ESP_LOGW(TAG, "TX queue full, dropping '%.*s'", shown, cmd);
+    return nullptr;
+  }
+  if (this->no_heap_ && len > this->max_command_length_) {
+    ESP_LOGW(TAG, "Command longer than %u bytes, dropping '%.*s'",
+             this->max_command_length_, shown, cmd);
+    return nullptr;
+  }
+  TxItem& item =
+      this->tx_queue_[(this->tx_head_ + this->tx_count_) % this->tx_queue_.size()];
+  item.line.clear();
+  item.owner = owner;
+  return &item.line;
+}
+
+void XRSRadioComponent::commit_tx_slot_(std::string* line) {
+  ESP_LOGD(TAG, "TX: %s", line->c_str());
+  line->append("\r\n", 2);
+  this->tx_count_++;
+  this->enable_loop();
+}
+
+void XRSRadioComponent::drain_tx_queue_() {
+  if (!this->connected_ || this->spp_handle_ == 0) {
+    this->tx_count_ = 0;
     return;
   }
-  std::string line = cmd;
-  line += "\r\n";
-  ESP_LOGD(TAG, "TX: %s", cmd.c_str());
-  auto* data =
-      const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(line.data()));
-  esp_err_t err =
-      esp_spp_write(this->spp_handle_, static_cast<int>(line.size()), data);
-  if (err != ESP_OK) {
-    ESP_LOGW(TAG, "esp_spp_write failed: %d", static_cast<int>(err));
+  size_t sent = 0;
+  while (this->tx_count_ != 0 && !this->tx_congested_ && sent < TX_BURST) {
+    TxItem& item = this->tx_queue_[this->tx_head_];
+    auto* data = const_cast<uint8_t*>(
+        reinterpret_cast<const uint8_t*>(item.line.data()));
+    esp_err_t err = esp_spp_write(this->spp_handle_,
+                                  static_cast<int>(item.line.size()), data);
+    if (err != ESP_OK) {
+      ESP_LOGW(TAG, "esp_spp_write failed: %d", static_cast<int>(err));
+#ifdef USE_XRS_AT_BRIDGE
+      this->at_bridge_.send_to(item.owner, "ERROR");
+#endif
+    } else {
+      const uint32_t now = esphome::millis();
+      // Every queued line ends in CRLF; the echo comes back without it.
+      const size_t len = item.line.size() - 2;
+      // The table query's OK follows its whole dump, which can outlast the
+      // tracker's timeout; its end of load depends on matching that OK.
+      const bool keep = len == strlen(CHANNEL_TABLE_QUERY) &&
+                        memcmp(item.line.data(), CHANNEL_TABLE_QUERY, len) == 0;
+      this->commands_.on_sent(now, item.line.data(), len, keep);
+#ifdef USE_XRS_AT_BRIDGE
+      this->at_bridge_.on_command_sent(now, item.owner, item.line);
+#endif
+    }
+    this->tx_head_ = (this->tx_head_ + 1) % this->tx_queue_.size();
+    this->tx_count_--;
+    sent++;
+  }
+}
+
+#ifdef USE_XRS_AT_BRIDGE
+bool XRSRadioComponent::submit_bridge_command_(uint8_t owner,
+                                               const std::string& line) {
+  if (!this->connected_ || this->spp_handle_ == 0) {
+    this->at_bridge_.send_to(owner, "ERROR");
+    return true;
   }
+  if (this->tx_count_ >= this->tx_queue_.size()) return false;
+  this->send_command_(line.data(), line.size(), owner);
+  return true;
 }
+#endif
 
 void XRSRadioComponent::send_handshake_commands_() {
-  this->send_command_("ATE1");
+  this->set_link_state_(XRS_LINK_IDENTIFY);
+  this->send_command_(this->echo_ ? "ATE1" : "ATE0");
   this->send_command_("ATV1");
-  this->send_command_("AT+GMI?");
-  this->send_command_("AT+GMM?");
-  this->send_command_("AT+GMR?");
-  this->send_command_("AT+GSN?");
+
+  // Identity belongs to this radio's MAC, so answers from an earlier
+  // connection stay valid and are not asked again.
+  this->identity_awaiting_ = 0;
+  if (this->manufacturer_.empty()) {
+    this->send_command_("AT+GMI?");
+    this->identity_awaiting_ |= IDENT_GMI;
+  }
+  if (this->model_.empty()) {
+    this->send_command_("AT+GMM?");
+    this->identity_awaiting_ |= IDENT_GMM;
+  }
+  if (this->firmware_.empty()) {
+    this->send_command_("AT+GMR?");
+    this->identity_awaiting_ |= IDENT_GMR;
+  }
+  if (this->serial_.empty()) {
+    this->send_command_("AT+GSN?");
+    this->identity_awaiting_ |= IDENT_GSN;
+  }
   this->send_command_("AT+GOI?");
-  this->request_channel_table();
-}
+  this->request_s109_();
 
-void XRSRadioComponent::send_location_update_() {
-  if (this->latitude_sensor_ == nullptr || this->longitude_sensor_ == nullptr)
-    return;
-  if (!this->latitude_sensor_->has_state() ||
-      !this->longitude_sensor_->has_state())
-    return;
+  // Re-assert the call state, or release a mute left over from a call that
+  // ended while we were disconnected.
+  if (this->call_active_ || this->active_mute_engaged_)
+    this->on_call_state_(this->call_active_);
 
-  const float lat = this->latitude_sensor_->state;
-  const float lon = this->longitude_sensor_->state;
-  if (std::isnan(lat) || std::isnan(lon)) return;
+  if (this->identity_awaiting_ == 0) {
+    this->start_table_step_();
+    return;
+  }
+  this->set_timeout("handshake_step", IDENTIFY_TIMEOUT_MS, [this]() {
+    ESP_LOGW(TAG, "Identification incomplete after %u ms, continuing",
+             IDENTIFY_TIMEOUT_MS);
+    this->start_table_step_();
+  });
+}
 
-  char buf[128];
-  snprintf(buf, sizeof(buf), "AT+WGTLOC=000000,%.6f,%.6f", lat, lon);
-  this->send_command_(buf);
+void XRSRadioComponent::on_identity_reply_(uint8_t bit) {
+  this->identity_awaiting_ &= ~bit;
+  if (this->link_state_ == XRS_LINK_IDENTIFY && this->identity_awaiting_ == 0) {
+    this->cancel_timeout("handshake_step");
+    this->start_table_step_();
+  }
 }
 
-void XRSRadioComponent::publish_connection_state_() {
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_CONNECTED) p.second->publish_state(this->connected_);
+void XRSRadioComponent::start_table_step_() {
+  if (this->link_state_ != XRS_LINK_IDENTIFY) return;
+  this->set_link_state_(XRS_LINK_TABLE);
+  this->request_channel_table();
+  if (!this->channel_table_.empty()) {
+    // Usable with the cached table; the reload only reports changes.
+    this->set_link_state_(XRS_LINK_READY);
+    return;
   }
+  this->set_timeout("handshake_step", TABLE_TIMEOUT_MS, [this]() {
+    ESP_LOGW(TAG, "No channel table after %u ms, continuing", TABLE_TIMEOUT_MS);
+    this->set_link_state_(XRS_LINK_READY);
+  });
 }
 
-void XRSRadioComponent::publish_all_state_() {
-  for (auto& p : this->numeric_sensors_) {
-    switch (p.first) {
-      case XRS_SENSOR_CHANNEL:
-        p.second->publish_state(this->current_channel_);
-        break;
-      case XRS_SENSOR_ZONE:
-        p.second->publish_state(this->current_zone_);
-        break;
-      case XRS_SENSOR_VOLUME:
-        p.second->publish_state(this->current_volume_);
-        break;
-      case XRS_SENSOR_PTT_TIMER:
-        p.second->publish_state(this->ptt_timer_);
-        break;
+void XRSRadioComponent::set_link_state_(XRSLinkState state) {
+  if (state == this->link_state_) return;
+  static const char* const NAMES[] = {"down", "connecting", "identify",
+                                      "table", "ready"};
+  const XRSLinkState previous = this->link_state_;
+  const uint32_t now = esphome::millis();
+  ESP_LOGD(TAG, "Link %s -> %s after %u ms", NAMES[previous], NAMES[state],
+           now - this->link_state_since_);
+  this->link_state_ = state;
+  this->link_state_since_ = now;
+  this->update_state_snapshot_();
+
+  if (state == XRS_LINK_CONNECTING) this->connect_started_at_ = now;
+
+  if (state == XRS_LINK_READY) {
+    this->cancel_timeout("handshake_step");
+    this->time_to_ready_ms_ = now - this->connect_started_at_;
+    ESP_LOGI(TAG, "Radio ready %u ms after connecting", this->time_to_ready_ms_);
+    this->publish_binary_(XRS_BIN_READY, true);
+    for (auto& p : this->metric_sensors_) {
+      if (p.first == XRS_METRIC_TIME_TO_READY)
+        p.second->publish_state(this->time_to_ready_ms_);
     }
+    // The radio does not keep our status across connections.
+    this->status_message_.reset_sent();
+    this->send_status_message_();
+  } else if (previous == XRS_LINK_READY) {
+    this->publish_binary_(XRS_BIN_READY, false);
   }
+}
 
-  for (auto& p : this->numbers_) {
-    if (p.first == XRS_NUMBER_VOLUME)
-      p.second->publish_state(this->current_volume_);
+void XRSRadioComponent::on_status_input_(size_t index, const std::string& text) {
+  if (!this->status_message_.set_input(index, text)) return;
+  // Coalesce inputs that change in the same tick into one message.
+  this->defer("status_message", [this]() {
+    this->run_checked_(&XRSRadioComponent::send_status_message_);
+  });
+}
+
+void XRSRadioComponent::send_status_message_() {
+  if (!this->status_enabled_ || !this->connected_) return;
+  if (!this->status_message_.pending()) return;
+
+  const uint32_t now = esphome::millis();
+  if (!this->status_message_.has_token(now)) {
+    const uint32_t wait = this->status_message_.ms_until_token(now);
+    ESP_LOGD(TAG, "Status message rate limited, retrying in %u ms", wait);
+    this->set_timeout("status_message", wait, [this]() {
+      this->run_checked_(&XRSRadioComponent::send_status_message_);
+    });
+    return;
+  }
+  // Built in the queue slot itself: the payload can outgrow any
+  // short-string buffer, and no-heap mode must not allocate here.
+  static const char PREFIX[] = "AT+WGTMSG=\"";
+  const std::string& payload = this->status_message_.payload();
+  std::string* line =
+      this->claim_tx_slot_(PREFIX, sizeof(PREFIX) - 2,
+                           sizeof(PREFIX) - 1 + payload.size() + 1, TX_OWNER_HUB);
+  if (line == nullptr) {
+    // Not sent, so no token spent; a reconnect resends it anyway.
+    if (this->connected_)
+      this->set_timeout("status_message", STATUS_MESSAGE_RETRY_MS, [this]() {
+        this->run_checked_(&XRSRadioComponent::send_status_message_);
+      });
+    return;
+  }
+  line->append(PREFIX, sizeof(PREFIX) - 1);
+  line->append(payload);
+  line->push_back('"');
+  this->commit_tx_slot_(line);
+  this->status_message_.mark_sent(now);
+}
+
+void XRSRadioComponent::on_location_sensor_update_() {
+  if (!this->latitude_sensor_->has_state() ||
+      !this->longitude_sensor_->has_state())
+    return;
+  const float lat = this->latitude_sensor_->state;
+  const float lon = this->longitude_sensor_->state;
+  if (std::isnan(lat) || std::isnan(lon)) return;
+
+  if (!this->location_filter_.update(esphome::millis(), lat, lon)) {
+    ESP_LOGD(TAG, "Rejected location fix %.6f,%.6f (%u rejected so far)", lat,
+             lon, this->location_filter_.rejected());
+  }
+}
+
+void XRSRadioComponent::send_location_update_(double lat, double lon) {
+  // HHMMSS in UTC; the radio accepts 000000 when no clock is available.
+  unsigned hh = 0;
+  unsigned mm = 0;
+  unsigned ss = 0;
+#ifdef USE_TIME
+  if (this->time_ != nullptr) {
+    ESPTime t = this->time_->utcnow();
+    if (t.is_valid()) {
+      hh = t.hour;
+      mm = t.minute;
+      ss = t.second;
+    }
   }
+#endif
 
+  char buf[128];
+  snprintf(buf, sizeof(buf), "AT+WGTLOC=%02u%02u%02u,%.6f,%.6f", hh, mm, ss,
+           lat, lon);
+  this->send_command_(buf);
+}
+
+void XRSRadioComponent::update_state_snapshot_() {
+  XRSRadioState s{};
+  s.channel_table_hash = this->channel_table_hash_;
+  s.time_to_ready_ms = this->time_to_ready_ms_;
+  s.ptt_timer = this->ptt_timer_;
+  s.link_state = this->link_state_;
+  s.zone = static_cast<uint8_t>(this->current_zone_);
+  s.channel = static_cast<uint8_t>(this->current_channel_);
+  s.radio_zone = static_cast<uint8_t>(this->radio_zone_);
+  s.radio_channel = static_cast<uint8_t>(this->radio_channel_);
+  s.volume = static_cast<uint8_t>(this->current_volume_);
+  s.power_state = static_cast<uint8_t>(this->power_state_);
+  s.has_level = this->level_.has_value();
+  s.level = this->level_.level();
+  s.level_coarse = this->level_.coarse();
+  s.connected = this->connected_;
+  s.change_pending = this->change_pending_;
+  s.ptt_active = this->ptt_active_;
+  s.ptt_data = this->ptt_data_;
+  s.power_low = this->power_low_;
+  s.scanning = this->scanning_;
+  s.duplex_enabled = this->duplex_enabled_;
+  s.silent_memory = this->silent_memory_;
+  s.quiet_memory = this->quiet_memory_;
+  s.quiet_mode = this->quiet_mode_;
+  this->state_.write(s);
+}
+
+void XRSRadioComponent::publish_connection_state_() {
+  this->publish_binary_(XRS_BIN_CONNECTED, this->connected_);
+}
+
+void XRSRadioComponent::publish_numeric_(XRSNumericSensorType type,
+                                         float value) {
+  this->update_state_snapshot_();
+  HeapGuard::Pause pause;
+  for (auto& p : this->numeric_sensors_) {
+    if (p.first == type) {
+      p.second->publish_state(value);
+      this->metrics_.publishes++;
+    }
+  }
+}
+
+void XRSRadioComponent::publish_binary_(XRSBinarySensorType type, bool value) {
+  this->update_state_snapshot_();
+  HeapGuard::Pause pause;
   for (auto& p : this->binary_sensors_) {
-    switch (p.first) {
-      case XRS_BIN_CONNECTED:
-        p.second->publish_state(this->connected_);
-        break;
-      case XRS_BIN_PTT_ACTIVE:
-        p.second->publish_state(this->ptt_active_);
-        break;
-      case XRS_BIN_PTT_DATA:
-        p.second->publish_state(this->ptt_data_);
-        break;
-      case XRS_BIN_POWER_LOW:
-        p.second->publish_state(this->power_low_);
-        break;
-      case XRS_BIN_SCANNING:
-        p.second->publish_state(this->scanning_);
-        break;
-      case XRS_BIN_DUPLEX_ENABLED:
-        p.second->publish_state(this->duplex_enabled_);
-        break;
-      case XRS_BIN_SILENT_MEMORY:
-        p.second->publish_state(this->silent_memory_);
-        break;
-      case XRS_BIN_QUIET_MEMORY:
-        p.second->publish_state(this->quiet_memory_);
-        break;
-      case XRS_BIN_QUIET_MODE:
-        p.second->publish_state(this->quiet_mode_);
-        break;
+    if (p.first == type) {
+      p.second->publish_state(value);
+      this->metrics_.publishes++;
     }
   }
+}
 
+void XRSRadioComponent::publish_text_(XRSTextSensorType type,
+                                      const std::string& value) {
+  this->update_state_snapshot_();
+  HeapGuard::Pause pause;
   for (auto& p : this->text_sensors_) {
-    switch (p.first) {
-      case XRS_TEXT_MANUFACTURER:
-        p.second->publish_state(this->manufacturer_);
-        break;
-      case XRS_TEXT_MODEL:
-        p.second->publish_state(this->model_);
-        break;
-      case XRS_TEXT_FIRMWARE:
-        p.second->publish_state(this->firmware_);
-        break;
-      case XRS_TEXT_SERIAL:
-        p.second->publish_state(this->serial_);
-        break;
-      case XRS_TEXT_LAST_MESSAGE:
-        break;
-      case XRS_TEXT_POWER_STATE: {
-        std::string txt;
-        switch (this->power_state_) {
-          case 0:
-            txt = "Booting";
-            break;
-          case 1:
-            txt = "Running";
-            break;
-          case 2:
-            txt = "Reset initiated";
-            break;
-          case 3:
-            txt = "Power down initiated";
-            break;
-          case 4:
-            txt = "Power down";
-            break;
-          case 5:
-            txt = "Low battery";
-            break;
-        }
-        if (!txt.empty()) p.second->publish_state(txt);
-        break;
-      }
-      case XRS_TEXT_PTT_STATE: {
-        std::string txt;
-        if (!this->ptt_active_) {
-          txt = "Idle";
-        } else if (this->ptt_data_) {
-          txt = "Transmitting voice+data";
-        } else {
-          txt = "Transmitting voice";
-        }
-        p.second->publish_state(txt);
-        break;
-      }
-      case XRS_TEXT_CHANNEL_LABEL:
-        this->publish_channel_label_();
-        break;
+    if (p.first == type) {
+      p.second->publish_state(value);
+      this->metrics_.publishes++;
     }
   }
 }
 
+void XRSRadioComponent::publish_text_(XRSTextSensorType type,
+                                      const char* value, bool always) {
+  this->update_state_snapshot_();
+  for (auto& p : this->text_sensors_) {
+    if (p.first != type) continue;
+    if (!always && p.second->has_state() && p.second->state == value) continue;
+    if (this->text_scratch_.c_str() != value) this->text_scratch_.assign(value);
+    HeapGuard::Pause pause;
+    p.second->publish_state(this->text_scratch_);
+    this->metrics_.publishes++;
+  }
+}
+
+void XRSRadioComponent::publish_number_(XRSNumberType type, float value) {
+  this->update_state_snapshot_();
+  HeapGuard::Pause pause;
+  for (auto& p : this->numbers_) {
+    if (p.first == type) {
+      p.second->publish_state(value);
+      this->metrics_.publishes++;
+    }
+  }
+}
+
+void XRSRadioComponent::publish_switch_(XRSSwitchType type, bool value) {
+  this->update_state_snapshot_();
+  HeapGuard::Pause pause;
+  for (auto& p : this->switches_) {
+    if (p.first == type) {
+      p.second->publish_state(value);
+      this->metrics_.publishes++;
+    }
+  }
+}
+
+const char* XRSRadioComponent::ptt_state_text_() const {
+  if (!this->ptt_active_) return "Idle";
+  if (this->ptt_data_) return "Transmitting voice+data";
+  return "Transmitting voice";
+}
+
+const char* XRSRadioComponent::power_state_text_() const {
+  switch (this->power_state_) {
+    case 0:
+      return "Booting";
+    case 1:
+      return "Running";
+    case 2:
+      return "Reset initiated";
+    case 3:
+      return "Power down initiated";
+    case 4:
+      return "Power down";
+    case 5:
+      return "Low battery";
+    default:
+      return "";
+  }
+}
+
+void XRSRadioComponent::publish_all_state_() {
+  this->publish_numeric_(XRS_SENSOR_CHANNEL, this->current_channel_);
+  this->publish_numeric_(XRS_SENSOR_ZONE, this->current_zone_);
+  this->publish_numeric_(XRS_SENSOR_VOLUME, this->current_volume_);
+  this->publish_numeric_(XRS_SENSOR_PTT_TIMER, this->ptt_timer_);
+
+  this->publish_number_(XRS_NUMBER_VOLUME, this->current_volume_);
+
+  this->publish_binary_(XRS_BIN_CONNECTED, this->connected_);
+  this->publish_binary_(XRS_BIN_PTT_ACTIVE, this->ptt_active_);
+  this->publish_binary_(XRS_BIN_PTT_DATA, this->ptt_data_);
+  this->publish_binary_(XRS_BIN_POWER_LOW, this->power_low_);
+  this->publish_binary_(XRS_BIN_SCANNING, this->scanning_);
+  this->publish_binary_(XRS_BIN_DUPLEX_ENABLED, this->duplex_enabled_);
+  this->publish_binary_(XRS_BIN_SILENT_MEMORY, this->silent_memory_);
+  this->publish_binary_(XRS_BIN_QUIET_MEMORY, this->quiet_memory_);
+  this->publish_binary_(XRS_BIN_QUIET_MODE, this->quiet_mode_);
+
+  this->publish_text_(XRS_TEXT_MANUFACTURER, this->manufacturer_);
+  this->publish_text_(XRS_TEXT_MODEL, this->model_);
+  this->publish_text_(XRS_TEXT_FIRMWARE, this->firmware_);
+  this->publish_text_(XRS_TEXT_SERIAL, this->serial_);
+  const char* power_txt = this->power_state_text_();
+  if (power_txt[0] != '\0')
+    this->publish_text_(XRS_TEXT_POWER_STATE, power_txt);
+  this->publish_text_(XRS_TEXT_PTT_STATE, this->ptt_state_text_());
+  this->publish_channel_label_();
+}
+
 void XRSRadioComponent::handle_ptt_notification_(int state, int timer) {
+  const bool was_active = this->ptt_active_;
   this->ptt_active_ = (state == 1 || state == 2);
   this->ptt_data_ = (state == 2);
   this->ptt_timer_ = (state == 2 && timer > 0) ? timer : 0;
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_PTT_ACTIVE)
-      p.second->publish_state(this->ptt_active_);
-    else if (p.first == XRS_BIN_PTT_DATA)
-      p.second->publish_state(this->ptt_data_);
-  }
-  for (auto& p : this->numeric_sensors_) {
-    if (p.first == XRS_SENSOR_PTT_TIMER)
-      p.second->publish_state(this->ptt_timer_);
-  }
-  for (auto& p : this->text_sensors_) {
-    if (p.first == XRS_TEXT_PTT_STATE) {
-      std::string txt;
-      if (!this->ptt_active_) {
-        txt = "Idle";
-      } else if (this->ptt_data_) {
-        txt = "Transmitting voice+data";
-      } else {
-        txt = "Transmitting voice";
-      }
-      p.second->publish_state(txt);
+  if (this->ptt_active_ != was_active) {
+    const uint32_t now = esphome::millis();
+    // Charged to the channel the radio confirmed, not to a pending change
+    // that may still roll back.
+    const uint8_t zone = static_cast<uint8_t>(this->radio_zone_);
+    const uint8_t channel = static_cast<uint8_t>(this->radio_channel_);
+    XRSEvent* ev = this->record_event_(this->ptt_active_ ? XRS_EVENT_PTT_START
+                                                         : XRS_EVENT_PTT_STOP);
+    if (ev != nullptr) {
+      ev->zone = zone;
+      ev->channel = channel;
+      ev->value = this->ptt_active_ ? state : static_cast<int32_t>(now - this->ptt_started_at_);
+    }
+    if (this->ptt_active_) {
+      this->ptt_started_at_ = now;
+      this->airtime_.ptt_start(now, zone, channel);
+    } else {
+      this->airtime_.ptt_stop(now);
     }
   }
+
+  this->publish_binary_(XRS_BIN_PTT_ACTIVE, this->ptt_active_);
+  this->publish_binary_(XRS_BIN_PTT_DATA, this->ptt_data_);
+  this->publish_numeric_(XRS_SENSOR_PTT_TIMER, this->ptt_timer_);
+  this->publish_text_(XRS_TEXT_PTT_STATE, this->ptt_state_text_());
 }
 
 void XRSRadioComponent::handle_power_notification_(int state) {
+  if (state != this->power_state_) {
+    XRSEvent* ev = this->record_event_(XRS_EVENT_POWER_STATE);
+    if (ev != nullptr) ev->value = state;
+  }
   this->power_state_ = state;
   this->power_low_ = (state == 5);
 
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_POWER_LOW) p.second->publish_state(this->power_low_);
-  }
-  for (auto& p : this->text_sensors_) {
-    if (p.first == XRS_TEXT_POWER_STATE) {
-      std::string txt;
-      switch (state) {
-        case 0:
-          txt = "Booting";
-          break;
-        case 1:
-          txt = "Running";
-          break;
-        case 2:
-          txt = "Reset initiated";
-          break;
-        case 3:
-          txt = "Power down initiated";
-          break;
-        case 4:
-          txt = "Power down";
-          break;
-        case 5:
-          txt = "Low battery";
-          break;
-      }
-      if (!txt.empty()) p.second->publish_state(txt);
-    }
-  }
+  this->publish_binary_(XRS_BIN_POWER_LOW, this->power_low_);
+  const char* txt = this->power_state_text_();
+  if (txt[0] != '\0') this->publish_text_(XRS_TEXT_POWER_STATE, txt);
 }
 
 void XRSRadioComponent::handle_scan_notification_(int enabled) {
-  this->scanning_ = (enabled != 0);
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_SCANNING) p.second->publish_state(this->scanning_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_SCAN) p.second->publish_state(this->scanning_);
+  if ((enabled != 0) != this->scanning_) {
+    XRSEvent* ev = this->record_event_(XRS_EVENT_SCAN);
+    if (ev != nullptr) ev->value = enabled != 0;
   }
+  this->scanning_ = (enabled != 0);
+  this->publish_binary_(XRS_BIN_SCANNING, this->scanning_);
+  this->publish_switch_(XRS_SWITCH_SCAN, this->scanning_);
 }
 
 void XRSRadioComponent::handle_duplex_notification_(int enabled) {
   this->duplex_enabled_ = (enabled != 0);
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_DUPLEX_ENABLED)
-      p.second->publish_state(this->duplex_enabled_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_DUPLEX)
-      p.second->publish_state(this->duplex_enabled_);
-  }
+  this->publish_binary_(XRS_BIN_DUPLEX_ENABLED, this->duplex_enabled_);
+  this->publish_switch_(XRS_SWITCH_DUPLEX, this->duplex_enabled_);
 }
 
 void XRSRadioComponent::handle_silent_memory_notification_(int enabled) {
   this->silent_memory_ = (enabled != 0);
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_SILENT_MEMORY)
-      p.second->publish_state(this->silent_memory_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_SILENT_MEMORY)
-      p.second->publish_state(this->silent_memory_);
-  }
+  this->publish_binary_(XRS_BIN_SILENT_MEMORY, this->silent_memory_);
+  this->publish_switch_(XRS_SWITCH_SILENT_MEMORY, this->silent_memory_);
 }
 
 void XRSRadioComponent::handle_quiet_memory_notification_(int enabled) {
   this->quiet_memory_ = (enabled != 0);
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_QUIET_MEMORY)
-      p.second->publish_state(this->quiet_memory_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_QUIET_MEMORY)
-      p.second->publish_state(this->quiet_memory_);
-  }
+  this->publish_binary_(XRS_BIN_QUIET_MEMORY, this->quiet_memory_);
+  this->publish_switch_(XRS_SWITCH_QUIET_MEMORY, this->quiet_memory_);
 }
 
 void XRSRadioComponent::handle_quiet_mode_notification_(int enabled) {
   this->quiet_mode_ = (enabled != 0);
-  for (auto& p : this->binary_sensors_) {
-    if (p.first == XRS_BIN_QUIET_MODE)
-      p.second->publish_state(this->quiet_mode_);
-  }
-  for (auto& p : this->switches_) {
-    if (p.first == XRS_SWITCH_QUIET_MODE)
-      p.second->publish_state(this->quiet_mode_);
-  }
+  this->publish_binary_(XRS_BIN_QUIET_MODE, this->quiet_mode_);
+  this->publish_switch_(XRS_SWITCH_QUIET_MODE, this->quiet_mode_);
 }
 
 void XRSRadioComponent::request_channel_table() {
@@ -875,10 +1772,14 @@ void XRSRadioComponent::request_channel_table() {
     return;
   }
   ESP_LOGI(TAG, "Requesting channel/squelch table via AT_WGCHSQ");
-  this->send_command_("AT_WGCHSQ");
+  this->channel_table_load_gen_++;
+  this->channel_table_load_active_ = true;
+  this->send_command_(CHANNEL_TABLE_QUERY);
+  this->set_timeout("channel_table_end", CHANNEL_TABLE_FALLBACK_MS,
+                    [this]() { this->end_channel_table_load_(true); });
 }
 
-std::string XRSRadioComponent::get_channel_label_(uint8_t zone,
+const char* XRSRadioComponent::get_channel_label_(uint8_t zone,
                                                   uint8_t channel) const {
   for (const auto& entry : this->channel_table_) {
     if (entry.zone == zone && entry.channel == channel) return entry.label;
@@ -886,122 +1787,702 @@ std::string XRSRadioComponent::get_channel_label_(uint8_t zone,
   return "";
 }
 
-void XRSRadioComponent::publish_channel_label_() {
-  std::string label =
-      this->get_channel_label_(static_cast<uint8_t>(this->current_zone_),
-                               static_cast<uint8_t>(this->current_channel_));
-  if (label.empty()) {
-    label =
-        str_sprintf("Z%u / Ch %u", this->current_zone_, this->current_channel_);
+XRSEvent* XRSRadioComponent::record_event_(XRSEventType type) {
+  if (this->event_log_.capacity() == 0) return nullptr;
+  return &this->event_log_.push(esphome::millis(), type);
+}
+
+void XRSRadioComponent::export_events(uint16_t max_events) {
+  const uint32_t end = this->event_log_.next_seq();
+  uint32_t start = this->event_log_.oldest_seq();
+  if (max_events != 0 && end - start > max_events) start = end - max_events;
+
+  ESP_LOGI(TAG, "Exporting %u of %u events (capacity %u)",
+           static_cast<unsigned>(end - start),
+           static_cast<unsigned>(this->event_log_.size()),
+           static_cast<unsigned>(this->event_log_.capacity()));
+  this->export_active_ = true;
+  this->export_next_seq_ = start;
+  this->export_end_seq_ = end;
+  this->set_timeout("event_export", 0, [this]() {
+    this->run_checked_(&XRSRadioComponent::export_events_chunk_);
+  });
+}
+
+void XRSRadioComponent::export_events_chunk_() {
+  if (!this->export_active_) return;
+
+  // Entries overwritten since the export started are skipped, not waited for.
+  const uint32_t oldest = this->event_log_.oldest_seq();
+  if (static_cast<int32_t>(oldest - this->export_next_seq_) > 0) {
+    ESP_LOGW(TAG, "Event export skipped %u overwritten entries",
+             static_cast<unsigned>(oldest - this->export_next_seq_));
+    this->export_next_seq_ = oldest;
+  }
+
+  // Each event takes at most EXPORT_EVENT_BYTES; the line break before it
+  // takes the place of the previous event's terminator.
+  char* buf = this->export_buf_;
+  const size_t cap = sizeof(this->export_buf_);
+  size_t used = 0;
+  size_t emitted = 0;
+  while (emitted < EXPORT_CHUNK_EVENTS &&
+         this->export_next_seq_ != this->export_end_seq_) {
+    const XRSEvent* ev = this->event_log_.find(this->export_next_seq_++);
+    if (ev == nullptr) continue;
+    if (used > 0) buf[used++] = '\n';
+    char* line = buf + used;
+    used += EventLog::format(*ev, line, std::min(EXPORT_EVENT_BYTES, cap - used));
+    ESP_LOGI(TAG, "event %s", line);
+    emitted++;
+  }
+  if (used > 0) this->publish_text_(XRS_TEXT_EVENT_EXPORT, buf, true);
+
+  if (this->export_next_seq_ == this->export_end_seq_) {
+    this->export_active_ = false;
+    ESP_LOGI(TAG, "Event export complete");
+    return;
   }
-  for (auto& p : this->text_sensors_) {
-    if (p.first == XRS_TEXT_CHANNEL_LABEL) p.second->publish_state(label);
+  this->set_timeout("event_export", EXPORT_CHUNK_DELAY_MS, [this]() {
+    this->run_checked_(&XRSRadioComponent::export_events_chunk_);
+  });
+}
+
+void XRSRadioComponent::export_channel_table(XRSTableExportFormat format) {
+  if (this->table_export_active_) {
+    ESP_LOGW(TAG, "Channel table export already running");
+    return;
   }
+  ESP_LOGI(TAG, "Exporting %u channel table rows as %s",
+           static_cast<unsigned>(this->channel_table_.size()),
+           format == XRS_TABLE_EXPORT_JSON ? "JSON" : "CSV");
+  this->table_export_active_ = true;
+  this->table_export_format_ = format;
+  this->table_export_next_ = 0;
+  this->table_export_hash_ = this->channel_table_hash_;
+  this->set_timeout("table_export", 0, [this]() {
+    this->run_checked_(&XRSRadioComponent::export_table_chunk_);
+  });
 }
 
-void XRSRadioComponent::handle_channel_table_line_(const std::string& line) {
-  std::string payload = ATParser::extract_payload(line, "+WGCHSQ:");
-  if (payload.empty()) return;
+// Append `text` to `out` as a CSV field, quoted if it needs to be.
+static size_t append_csv_field(char* out, size_t len, const char* text) {
+  if (len == 0) return 0;
+  const bool quote = strpbrk(text, ",\"\r\n") != nullptr;
+  size_t n = 0;
+  if (quote && n + 1 < len) out[n++] = '"';
+  for (const char* p = text; *p != '\0'; p++) {
+    const char c = *p;
+    if (quote && c == '"' && n + 1 < len) out[n++] = '"';
+    if (n + 1 < len) out[n++] = c;
+  }
+  if (quote && n + 1 < len) out[n++] = '"';
+  out[n] = '\0';
+  return n;
+}
+
+// Append `text` to `out` as a JSON string literal.
+static size_t append_json_string(char* out, size_t len, const char* text) {
+  if (len == 0) return 0;
+  size_t n = 0;
+  if (n + 1 < len) out[n++] = '"';
+  for (const char* p = text; *p != '\0'; p++) {
+    const char c = *p;
+    char esc[8];
+    int m;
+    if (c == '"' || c == '\\') {
+      m = snprintf(esc, sizeof(esc), "\\%c", c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      m = snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned>(c));
+    } else {
+      esc[0] = c;
+      m = 1;
+    }
+    if (n + m + 1 >= len) break;
+    memcpy(out + n, esc, m);
+    n += m;
+  }
+  if (n + 1 < len) out[n++] = '"';
+  out[n] = '\0';
+  return n;
+}
+
+size_t XRSRadioComponent::format_table_row_(const ChannelInfo& row, bool first,
+                                            char* buf, size_t len) const {
+  int n;
+  if (this->table_export_format_ == XRS_TABLE_EXPORT_JSON) {
+    n = snprintf(buf, len,
+                 "%s{\"zone\":%u,\"channel\":%u,\"rx_mhz\":%.4f,\"tx_mhz\":%.4f,"
+                 "\"label\":",
+                 first ? "" : ",", row.zone, row.channel, row.rx_freq,
+                 row.tx_freq);
+  } else {
+    n = snprintf(buf, len, "%u,%u,%.4f,%.4f,", row.zone, row.channel,
+                 row.rx_freq, row.tx_freq);
+  }
+  if (n < 0 || static_cast<size_t>(n) >= len) return 0;
+  size_t used = static_cast<size_t>(n);
+  if (this->table_export_format_ == XRS_TABLE_EXPORT_JSON) {
+    used += append_json_string(buf + used, len - used, row.label);
+    if (used + 1 < len) buf[used++] = '}';
+  } else {
+    used += append_csv_field(buf + used, len - used, row.label);
+  }
+  if (used + 1 < len) buf[used++] = '\n';
+  buf[used] = '\0';
+  return used;
+}
+
+void XRSRadioComponent::export_table_chunk_() {
+  if (!this->table_export_active_) return;
+
+  if (this->channel_table_hash_ != this->table_export_hash_) {
+    ESP_LOGW(TAG, "Channel table changed during export, aborting at row %u",
+             static_cast<unsigned>(this->table_export_next_));
+    this->table_export_active_ = false;
+    return;
+  }
+
+  const bool json = this->table_export_format_ == XRS_TABLE_EXPORT_JSON;
+  char* buf = this->table_export_buf_;
+  const size_t cap = sizeof(this->table_export_buf_);
+  size_t used = 0;
+  if (this->table_export_next_ == 0) {
+    used = snprintf(buf, cap, "%s",
+                    json ? "[\n" : "zone,channel,rx_mhz,tx_mhz,label\n");
+  }
+
+  // Pack whole rows until the next one would not fit, keeping room for the
+  // closing JSON bracket.
+  const size_t reserve = json ? 2 : 0;
+  char row[160];
+  const size_t rows = this->channel_table_.size();
+  while (this->table_export_next_ < rows) {
+    const size_t n =
+        this->format_table_row_(this->channel_table_[this->table_export_next_],
+                                this->table_export_next_ == 0, row, sizeof(row));
+    if (used + n + reserve >= cap) break;
+    memcpy(buf + used, row, n);
+    used += n;
+    this->table_export_next_++;
+  }
+  const bool done = this->table_export_next_ >= rows;
+  if (done && json) {
+    buf[used++] = ']';
+    buf[used++] = '\n';
+  }
+  buf[used] = '\0';
+
+  // Drop the trailing newline for the log/text sensor.
+  if (used > 0 && buf[used - 1] == '\n') buf[used - 1] = '\0';
+  ESP_LOGI(TAG, "table %s", buf);
+  this->publish_text_(XRS_TEXT_TABLE_EXPORT, buf, true);
+
+  if (done) {
+    this->table_export_active_ = false;
+    ESP_LOGI(TAG, "Channel table export complete");
+    return;
+  }
+  this->set_timeout("table_export", EXPORT_CHUNK_DELAY_MS, [this]() {
+    this->run_checked_(&XRSRadioComponent::export_table_chunk_);
+  });
+}
+
+void XRSRadioComponent::format_channel_(uint8_t zone, uint8_t channel,
+                                        const char* label,
+                                        std::string& out) const {
+  char buf[16 + MAX_LABEL_LENGTH + 1];
+  if (label[0] == '\0') {
+    snprintf(buf, sizeof(buf), "Z%u / Ch %u", zone, channel);
+  } else {
+    snprintf(buf, sizeof(buf), "Z%u / Ch %u: %s", zone, channel, label);
+  }
+  out.assign(buf);
+}
 
-  auto parts = ATParser::split_args(payload);
-  if (parts.size() < 2) return;
+void XRSRadioComponent::publish_airtime_() {
+  this->airtime_.update(esphome::millis());
 
-  int zone = atoi(parts[0].c_str());
-  int ch = atoi(parts[1].c_str());
+  uint8_t order[AirtimeTracker::CAPACITY];
+  const size_t count = this->airtime_.ranking(order);
 
-  float rx = 0.0f;
-  float tx = 0.0f;
-  if (parts.size() >= 4) {
-    rx = static_cast<float>(atof(parts[2].c_str()));
-    tx = static_cast<float>(atof(parts[3].c_str()));
+  for (auto& p : this->numeric_sensors_) {
+    if (p.first < XRS_SENSOR_AIRTIME_TRANSMISSIONS ||
+        p.first > XRS_SENSOR_AIRTIME_DUTY_1H)
+      continue;
+    const uint8_t rank = p.second->get_rank();
+    if (rank == 0 || rank > count) continue;
+    AirtimeTracker::Stats st;
+    this->airtime_.stats(order[rank - 1], st);
+    float value = NAN;
+    switch (p.first) {
+      case XRS_SENSOR_AIRTIME_TRANSMISSIONS:
+        value = st.transmissions;
+        break;
+      case XRS_SENSOR_AIRTIME_SECONDS:
+        value = st.seconds;
+        break;
+      case XRS_SENSOR_AIRTIME_DUTY_1M:
+        value = st.duty_1m * 100.0f;
+        break;
+      case XRS_SENSOR_AIRTIME_DUTY_15M:
+        value = st.duty_15m * 100.0f;
+        break;
+      case XRS_SENSOR_AIRTIME_DUTY_1H:
+        value = st.duty_1h * 100.0f;
+        break;
+      default:
+        continue;
+    }
+    p.second->publish_state(value);
+    this->metrics_.publishes++;
   }
 
-  std::string label;
-  if (!parts.empty()) {
-    label = parts.back();
-    if (!label.empty() && label.front() == '\"') label.erase(0, 1);
-    if (!label.empty() && label.back() == '\"') label.pop_back();
-    while (!label.empty() && (label.front() == ' ' || label.front() == '\t'))
-      label.erase(label.begin());
-    while (!label.empty() && (label.back() == ' ' || label.back() == '\t'))
-      label.pop_back();
+  for (auto& p : this->text_sensors_) {
+    if (p.first != XRS_TEXT_AIRTIME_CHANNEL) continue;
+    const uint8_t rank = p.second->get_rank();
+    if (rank == 0 || rank > count) continue;
+    AirtimeTracker::Stats st;
+    this->airtime_.stats(order[rank - 1], st);
+    this->format_channel_(st.zone, st.channel,
+                          this->get_channel_label_(st.zone, st.channel),
+                          this->text_scratch_);
+    p.second->publish_state(this->text_scratch_);
+    this->metrics_.publishes++;
   }
+}
+
+void XRSRadioComponent::publish_channel_label_() {
+  const char* label =
+      this->get_channel_label_(static_cast<uint8_t>(this->current_zone_),
+                               static_cast<uint8_t>(this->current_channel_));
+  if (label[0] != '\0') {
+    this->text_scratch_.assign(label);
+  } else {
+    char buf[24];
+    snprintf(buf, sizeof(buf), "Z%u / Ch %u", this->current_zone_,
+             this->current_channel_);
+    this->text_scratch_.assign(buf);
+  }
+  this->publish_text_(XRS_TEXT_CHANNEL_LABEL, this->text_scratch_);
+}
 
-  ChannelInfo info;
-  info.zone = static_cast<uint8_t>(zone);
-  info.channel = static_cast<uint8_t>(ch);
-  info.rx_freq = rx;
-  info.tx_freq = tx;
-  info.label = label;
+void XRSRadioComponent::handle_level_notification_(int value) {
+  const uint8_t changed = this->level_.update(value);
+  if (changed & LevelTracker::CHANGED_LEVEL)
+    this->publish_numeric_(XRS_SENSOR_LEVEL, this->level_.level());
+  if (changed & LevelTracker::CHANGED_COARSE)
+    this->publish_numeric_(XRS_SENSOR_LEVEL_COARSE, this->level_.coarse());
+}
 
-  bool updated = false;
+void XRSRadioComponent::handle_channel_table_line_(const std::string& line) {
+  // Parsed in place: a dump is a few hundred rows, on every reconnect.
+  static const char PREFIX[] = "+WGCHSQ:";
+  const size_t pos = line.find(PREFIX);
+  if (pos == std::string::npos) return;
+  const char* payload = line.c_str() + pos + sizeof(PREFIX) - 1;
+  ATParser::Field parts[6];
+  const size_t count = ATParser::split_fields(
+      payload, line.size() - pos - (sizeof(PREFIX) - 1), parts, 6);
+  if (count < 2) return;
+
+  ChannelInfo info{};
+  info.zone = static_cast<uint8_t>(atoi(payload + parts[0].start));
+  info.channel = static_cast<uint8_t>(atoi(payload + parts[1].start));
+  if (count >= 4) {
+    info.rx_freq = static_cast<float>(atof(payload + parts[2].start));
+    info.tx_freq = static_cast<float>(atof(payload + parts[3].start));
+  }
+
+  // The last field, unquoted and trimmed.
+  const char* label = payload + parts[count - 1].start;
+  size_t label_len = parts[count - 1].len;
+  if (label_len > 0 && label[0] == '"') {
+    label++;
+    label_len--;
+  }
+  if (label_len > 0 && label[label_len - 1] == '"') label_len--;
+  while (label_len > 0 && (label[0] == ' ' || label[0] == '\t')) {
+    label++;
+    label_len--;
+  }
+  while (label_len > 0 &&
+         (label[label_len - 1] == ' ' || label[label_len - 1] == '\t'))
+    label_len--;
+  label_len = std::min(label_len, MAX_LABEL_LENGTH);
+  memcpy(info.label, label, label_len);
+  info.label[label_len] = '\0';
+  info.hash = channel_row_hash_(info);
+  info.load_gen = this->channel_table_load_gen_;
+
+  ChannelInfo* existing = nullptr;
   for (auto& entry : this->channel_table_) {
     if (entry.zone == info.zone && entry.channel == info.channel) {
-      entry = info;
-      updated = true;
+      existing = &entry;
       break;
     }
   }
-  if (!updated) this->channel_table_.push_back(info);
 
-  if (info.zone == this->current_zone_ &&
+  if (existing == nullptr && this->no_heap_ &&
+      this->channel_table_.size() >= this->channel_table_size_) {
+    ESP_LOGW(TAG, "Channel table full (%u rows), ignoring Z%u / Ch %u",
+             this->channel_table_size_, info.zone, info.channel);
+    return;
+  }
+
+  bool changed = true;
+  if (existing == nullptr) {
+    this->channel_table_hash_ += info.hash;
+    this->channel_table_.push_back(info);
+    this->channel_table_added_++;
+  } else if (existing->hash != info.hash) {
+    this->channel_table_hash_ += info.hash - existing->hash;
+    *existing = info;
+    this->channel_table_changed_++;
+  } else {
+    existing->load_gen = info.load_gen;
+    changed = false;
+  }
+  this->channel_table_rows_seen_++;
+
+  if (changed && info.zone == this->current_zone_ &&
       info.channel == this->current_channel_) {
     this->publish_channel_label_();
   }
 
-  for (auto& p : this->selects_) {
-    p.second->refresh_from_parent();
-  }
+  // Derived state is rebuilt once per dump, at its final result; this is
+  // only the fallback should that result never arrive.
+  this->set_timeout("channel_table_end", CHANNEL_TABLE_FALLBACK_MS,
+                    [this]() { this->end_channel_table_load_(true); });
 }
 
-void XRSRadioComponent::get_zone_options(std::vector<std::string>& out) const {
-  out.clear();
-  std::vector<uint8_t> zones;
-  for (const auto& c : this->channel_table_) {
-    if (std::find(zones.begin(), zones.end(), c.zone) == zones.end())
-      zones.push_back(c.zone);
-  }
-  if (zones.empty()) {
-    for (uint8_t z = 1; z <= 8; z++) zones.push_back(z);
-  }
-  std::sort(zones.begin(), zones.end());
-  for (auto z : zones) {
-    out.push_back(str_sprintf("Zone %u", static_cast<unsigned>(z)));
-  }
+void XRSRadioComponent::end_channel_table_load_(bool ok) {
+  this->cancel_timeout("channel_table_end");
+  // Ended by the fallback: the query's result is no longer waited for.
+  this->commands_.release();
+  // A dump ended by ERROR may be partial and must not count as complete.
+  if (!ok) this->channel_table_load_active_ = false;
+  this->finish_channel_table_load_();
+  if (this->link_state_ == XRS_LINK_TABLE)
+    this->set_link_state_(XRS_LINK_READY);
 }
 
-void XRSRadioComponent::get_channel_options(
-    std::vector<std::string>& out) const {
-  out.clear();
-  if (this->channel_table_.empty()) {
-    for (uint8_t z = 1; z <= 8; z++) {
-      for (uint8_t ch = 1; ch <= 80; ch++) {
-        out.push_back(str_sprintf("Z%u / Ch %u", z, ch));
-      }
+uint32_t XRSRadioComponent::channel_row_hash_(const ChannelInfo& info) {
+  uint32_t h = 2166136261UL;
+  auto mix = [&h](const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; i++) {
+      h ^= p[i];
+      h *= 16777619UL;
     }
+  };
+  mix(&info.zone, sizeof(info.zone));
+  mix(&info.channel, sizeof(info.channel));
+  mix(&info.rx_freq, sizeof(info.rx_freq));
+  mix(&info.tx_freq, sizeof(info.tx_freq));
+  mix(info.label, strlen(info.label));
+  return h;
+}
+
+void XRSRadioComponent::finish_channel_table_load_() {
+  if (this->channel_table_load_active_ && this->channel_table_rows_seen_ > 0) {
+    // A complete dump was received; anything it did not mention is gone.
+    const uint32_t gen = this->channel_table_load_gen_;
+    auto it = std::remove_if(
+        this->channel_table_.begin(), this->channel_table_.end(),
+        [this, gen](const ChannelInfo& ci) {
+          if (ci.load_gen == gen) return false;
+          this->channel_table_hash_ -= ci.hash;
+          this->channel_table_removed_++;
+          return true;
+        });
+    this->channel_table_.erase(it, this->channel_table_.end());
+  }
+  this->channel_table_load_active_ = false;
+
+  const uint16_t added = this->channel_table_added_;
+  const uint16_t changed = this->channel_table_changed_;
+  const uint16_t removed = this->channel_table_removed_;
+  const uint16_t seen = this->channel_table_rows_seen_;
+  this->channel_table_rows_seen_ = 0;
+  this->channel_table_added_ = 0;
+  this->channel_table_changed_ = 0;
+  this->channel_table_removed_ = 0;
+
+  if (added == 0 && changed == 0 && removed == 0) {
+    ESP_LOGD(TAG, "Channel table unchanged (%u rows, hash %08" PRIx32 ")",
+             seen, this->channel_table_hash_);
     return;
   }
 
+  ESP_LOGI(TAG,
+           "Channel table changed: %u added, %u changed, %u removed "
+           "(%u rows, hash %08" PRIx32 ")",
+           added, changed, removed,
+           static_cast<unsigned>(this->channel_table_.size()),
+           this->channel_table_hash_);
+  if (removed > 0) this->publish_channel_label_();
+  this->rebuild_frequency_index_();
+  this->rebuild_options_();
+
+  XRSEvent* ev = this->record_event_(XRS_EVENT_TABLE_CHANGED);
+  if (ev != nullptr) {
+    ev->value = static_cast<int32_t>(this->channel_table_hash_);
+    snprintf(ev->text, sizeof(ev->text), "+%u ~%u -%u", added, changed,
+             removed);
+  }
+  this->channel_table_change_callback_.call(this->channel_table_hash_);
+}
+
+void XRSRadioComponent::rebuild_options_() {
   std::vector<ChannelInfo> sorted = this->channel_table_;
+  if (sorted.empty()) {
+    // No table yet: offer every zone/channel the radio can address.
+    for (uint8_t z = 1; z <= MAX_ZONES; z++) {
+      for (uint8_t ch = 1; ch <= DEFAULT_CHANNELS; ch++) {
+        ChannelInfo ci{};
+        ci.zone = z;
+        ci.channel = ch;
+        sorted.push_back(ci);
+      }
+    }
+  }
   std::sort(sorted.begin(), sorted.end(),
             [](const ChannelInfo& a, const ChannelInfo& b) {
               if (a.zone != b.zone) return a.zone < b.zone;
               return a.channel < b.channel;
             });
 
+  std::fill(&this->zone_option_index_[0],
+            &this->zone_option_index_[0] + MAX_ZONES, NO_OPTION);
+  std::fill(&this->channel_option_index_[0][0],
+            &this->channel_option_index_[0][0] + MAX_ZONES * 256,
+            NO_OPTION);
+  this->zone_options_.clear();
+  this->zone_option_keys_.clear();
+  this->channel_options_.clear();
+  this->channel_option_keys_.clear();
+  // The whole-radio channel list is the big one; skip it unless a select
+  // actually shows it.
+  const bool full_channels = this->has_select_(XRS_SELECT_CHANNEL);
+  if (full_channels) {
+    this->channel_options_.reserve(sorted.size());
+    this->channel_option_keys_.reserve(sorted.size());
+  }
+
   for (const auto& ci : sorted) {
-    if (!ci.label.empty()) {
-      out.push_back(str_sprintf("Z%u / Ch %u: %s", ci.zone, ci.channel,
-                                ci.label.c_str()));
-    } else {
-      out.push_back(str_sprintf("Z%u / Ch %u", ci.zone, ci.channel));
+    const bool indexable = ci.zone >= 1 && ci.zone <= MAX_ZONES;
+    if (this->zone_option_keys_.empty() ||
+        this->zone_option_keys_.back() != ci.zone) {
+      if (indexable)
+        this->zone_option_index_[ci.zone - 1] =
+            static_cast<uint16_t>(this->zone_options_.size());
+      this->zone_options_.push_back(
+          str_sprintf("Zone %u", static_cast<unsigned>(ci.zone)));
+      this->zone_option_keys_.push_back(ci.zone);
     }
+    if (!full_channels) continue;
+    if (indexable)
+      this->channel_option_index_[ci.zone - 1][ci.channel] =
+          static_cast<uint16_t>(this->channel_options_.size());
+    this->channel_options_.emplace_back();
+    this->format_channel_(ci.zone, ci.channel, ci.label,
+                          this->channel_options_.back());
+    this->channel_option_keys_.push_back(
+        static_cast<uint16_t>((ci.zone << 8) | ci.channel));
+  }
+
+  this->options_version_[XRS_SELECT_ZONE]++;
+  this->options_version_[XRS_SELECT_CHANNEL]++;
+  if (this->has_select_(XRS_SELECT_ZONE_CHANNEL)) {
+    // Labels of the current zone may have changed.
+    this->zone_channel_options_zone_ = -1;
+    this->rebuild_zone_channel_options_();
+  }
+  for (auto& p : this->selects_) {
+    p.second->refresh_from_parent();
   }
 }
 
+void XRSRadioComponent::rebuild_frequency_index_() {
+  this->frequency_index_.clear();
+  for (const auto& ci : this->channel_table_) {
+    this->frequency_index_.add(ci.zone, ci.channel, ci.rx_freq, ci.tx_freq);
+  }
+  this->frequency_index_.finish();
+  ESP_LOGD(TAG, "Frequency index: %u RX, %u TX entries",
+           static_cast<unsigned>(this->frequency_index_.size(XRS_FREQ_RX)),
+           static_cast<unsigned>(this->frequency_index_.size(XRS_FREQ_TX)));
+}
+
+void XRSRadioComponent::tune_to_frequency(float mhz, XRSFrequencyBand band,
+                                          float tolerance_mhz) {
+  const FrequencyIndex::Entry* e =
+      this->frequency_index_.nearest(band, mhz, tolerance_mhz);
+  if (e == nullptr) {
+    ESP_LOGW(TAG, "No channel with %s frequency within %.4f MHz of %.4f MHz",
+             band == XRS_FREQ_TX ? "TX" : "RX", tolerance_mhz, mhz);
+    return;
+  }
+  ESP_LOGI(TAG, "Tuning to %.4f MHz: Z%u / Ch %u (%.4f MHz)", mhz, e->zone,
+           e->channel, e->mhz);
+  this->set_target_zone_channel(e->zone, e->channel);
+}
+
+void XRSRadioComponent::set_line_patterns(const LineMatcher::Node* nodes,
+                                          const uint16_t* terms,
+                                          const LineMatcher::Pattern* patterns,
+                                          uint16_t count) {
+  this->line_matcher_.configure(nodes, terms, patterns, count);
+  this->line_triggers_.resize(count, nullptr);
+}
+
+void XRSRadioComponent::register_line_trigger(
+    uint16_t index, Trigger<std::string, std::vector<std::string>>* trigger) {
+  if (index >= this->line_triggers_.size()) {
+    ESP_LOGW(TAG, "on_line trigger %u has no pattern", index);
+    return;
+  }
+  this->line_triggers_[index] = trigger;
+}
+
+void XRSRadioComponent::rebuild_zone_channel_options_() {
+  if (this->zone_channel_options_zone_ == this->current_zone_) return;
+  this->zone_channel_options_zone_ = this->current_zone_;
+
+  // Labels of the zone's channels by channel number (nullptr = absent),
+  // gathered in one pass over the table; this also sorts them.
+  const char* labels[256] = {};
+  size_t count = 0;
+  for (const auto& ci : this->channel_table_) {
+    if (ci.zone != this->current_zone_) continue;
+    labels[ci.channel] = ci.label;
+    count++;
+  }
+  if (this->channel_table_.empty() && this->current_zone_ >= 1 &&
+      this->current_zone_ <= MAX_ZONES) {
+    for (uint8_t ch = 1; ch <= DEFAULT_CHANNELS; ch++) labels[ch] = "";
+    count = DEFAULT_CHANNELS;
+  }
+
+  std::fill(&this->zone_channel_option_index_[0],
+            &this->zone_channel_option_index_[0] + 256,
+            NO_OPTION);
+  if (this->no_heap_) {
+    // Keep the capacity reserved in setup().
+    this->zone_channel_options_.clear();
+    this->zone_channel_option_keys_.clear();
+  } else {
+    // Swap with empty vectors so the previous zone's strings are released.
+    std::vector<std::string>().swap(this->zone_channel_options_);
+    std::vector<uint8_t>().swap(this->zone_channel_option_keys_);
+    this->zone_channel_options_.reserve(count);
+    this->zone_channel_option_keys_.reserve(count);
+  }
+  const uint8_t zone = static_cast<uint8_t>(this->current_zone_);
+  for (unsigned ch = 0; ch < 256; ch++) {
+    if (labels[ch] == nullptr) continue;
+    this->zone_channel_option_index_[ch] =
+        static_cast<uint16_t>(this->zone_channel_options_.size());
+    this->zone_channel_options_.emplace_back();
+    this->format_channel_(zone, static_cast<uint8_t>(ch), labels[ch],
+                          this->zone_channel_options_.back());
+    this->zone_channel_option_keys_.push_back(static_cast<uint8_t>(ch));
+  }
+  this->options_version_[XRS_SELECT_ZONE_CHANNEL]++;
+}
+
+bool XRSRadioComponent::has_select_(XRSSelectType type) const {
+  for (const auto& p : this->selects_) {
+    if (p.first == type) return true;
+  }
+  return false;
+}
+
+const std::vector<std::string>& XRSRadioComponent::get_options(
+    XRSSelectType type) const {
+  switch (type) {
+    case XRS_SELECT_ZONE:
+      return this->zone_options_;
+    case XRS_SELECT_ZONE_CHANNEL:
+      return this->zone_channel_options_;
+    default:
+      return this->channel_options_;
+  }
+}
+
+bool XRSRadioComponent::get_option_zone_channel(XRSSelectType type,
+                                                size_t index, uint8_t& zone,
+                                                uint8_t& channel) const {
+  if (type == XRS_SELECT_ZONE) {
+    if (index >= this->zone_option_keys_.size()) return false;
+    zone = this->zone_option_keys_[index];
+    channel = 0;
+    return true;
+  }
+  if (type == XRS_SELECT_ZONE_CHANNEL) {
+    if (index >= this->zone_channel_option_keys_.size()) return false;
+    zone = static_cast<uint8_t>(this->zone_channel_options_zone_);
+    channel = this->zone_channel_option_keys_[index];
+    return true;
+  }
+  if (index >= this->channel_option_keys_.size()) return false;
+  zone = static_cast<uint8_t>(this->channel_option_keys_[index] >> 8);
+  channel = static_cast<uint8_t>(this->channel_option_keys_[index] & 0xFF);
+  return true;
+}
+
+int XRSRadioComponent::get_current_option_index(XRSSelectType type) const {
+  const int zone = this->current_zone_;
+  const int ch = this->current_channel_;
+  if (zone < 1 || zone > MAX_ZONES) return -1;
+
+  uint16_t idx = NO_OPTION;
+  if (type == XRS_SELECT_ZONE) {
+    idx = this->zone_option_index_[zone - 1];
+  } else if (type == XRS_SELECT_ZONE_CHANNEL) {
+    if (zone != this->zone_channel_options_zone_) return -1;
+    if (ch >= 0 && ch <= 255) idx = this->zone_channel_option_index_[ch];
+  } else if (ch >= 0 && ch <= 255) {
+    idx = this->channel_option_index_[zone - 1][ch];
+  }
+  return idx == NO_OPTION ? -1 : idx;
+}
+
 void XRSRadioComponent::handle_line_(const std::string& line) {
   ESP_LOGD(TAG, "RX: %s", line.c_str());
-  if (line == "OK" || line == "ERROR") return;
+#ifdef USE_XRS_AT_BRIDGE
+  this->at_bridge_.on_line(line);
+#endif
+  // on_line: automations see every line, before and regardless of the
+  // built-in handling below.
+  this->line_matcher_.match(
+      line, [this, &line](uint16_t index, const LineMatcher::Field* fields,
+                          uint8_t count) {
+        auto* trigger = this->line_triggers_[index];
+        if (trigger == nullptr) return;
+        HeapGuard::Pause pause;
+        std::vector<std::string> values;
+        values.reserve(count);
+        for (uint8_t i = 0; i < count; i++)
+          values.emplace_back(line, fields[i].start, fields[i].len);
+        trigger->trigger(line, values);
+      });
+  if (line == "OK" || line == "ERROR") {
+    uint32_t rtt = 0;
+    uint32_t cmd_hash = 0;
+    if (this->commands_.on_result(esphome::millis(), rtt, cmd_hash)) {
+      this->metrics_.rtt_sum_ms += rtt;
+      this->metrics_.rtt_count++;
+      static const uint32_t TABLE_QUERY_HASH = CommandTracker::command_hash(
+          CHANNEL_TABLE_QUERY, strlen(CHANNEL_TABLE_QUERY));
+      if (this->channel_table_load_active_ && cmd_hash == TABLE_QUERY_HASH)
+        this->end_channel_table_load_(line == "OK");
+    }
+    return;
+  }
+
+  if (this->s109_read_pending_ && this->handle_s109_line_(line)) return;
 
   auto starts_with = [&](const char* prefix) -> bool {
     size_t len = strlen(prefix);
@@ -1010,35 +2491,29 @@ void XRSRadioComponent::handle_line_(const std::string& line) {
 
   if (starts_with("+GMI:")) {
     this->manufacturer_ = trim_copy(line.substr(5));
-    for (auto& p : this->text_sensors_) {
-      if (p.first == XRS_TEXT_MANUFACTURER)
-        p.second->publish_state(this->manufacturer_);
-    }
+    this->publish_text_(XRS_TEXT_MANUFACTURER, this->manufacturer_);
+    this->on_identity_reply_(IDENT_GMI);
     return;
   }
 
   if (starts_with("+GMM:")) {
     this->model_ = trim_copy(line.substr(5));
-    for (auto& p : this->text_sensors_) {
-      if (p.first == XRS_TEXT_MODEL) p.second->publish_state(this->model_);
-    }
+    this->publish_text_(XRS_TEXT_MODEL, this->model_);
+    this->on_identity_reply_(IDENT_GMM);
     return;
   }
 
   if (starts_with("+GMR:")) {
     this->firmware_ = trim_copy(line.substr(5));
-    for (auto& p : this->text_sensors_) {
-      if (p.first == XRS_TEXT_FIRMWARE)
-        p.second->publish_state(this->firmware_);
-    }
+    this->publish_text_(XRS_TEXT_FIRMWARE, this->firmware_);
+    this->on_identity_reply_(IDENT_GMR);
     return;
   }
 
   if (starts_with("+GSN:")) {
     this->serial_ = trim_copy(line.substr(5));
-    for (auto& p : this->text_sensors_) {
-      if (p.first == XRS_TEXT_SERIAL) p.second->publish_state(this->serial_);
-    }
+    this->publish_text_(XRS_TEXT_SERIAL, this->serial_);
+    this->on_identity_reply_(IDENT_GSN);
     return;
   }
 
@@ -1047,14 +2522,8 @@ void XRSRadioComponent::handle_line_(const std::string& line) {
     if (v < 0) v = 0;
     if (v > 31) v = 31;
     this->current_volume_ = v;
-    for (auto& p : this->numeric_sensors_) {
-      if (p.first == XRS_SENSOR_VOLUME)
-        p.second->publish_state(this->current_volume_);
-    }
-    for (auto& p : this->numbers_) {
-      if (p.first == XRS_NUMBER_VOLUME)
-        p.second->publish_state(this->current_volume_);
-    }
+    this->publish_numeric_(XRS_SENSOR_VOLUME, this->current_volume_);
+    this->publish_number_(XRS_NUMBER_VOLUME, this->current_volume_);
     return;
   }
 
@@ -1062,15 +2531,7 @@ void XRSRadioComponent::handle_line_(const std::string& line) {
     int zone = 0;
     int ch = 0;
     if (sscanf(line.c_str(), "+WGCHS: %d,%d", &zone, &ch) == 2) {
-      this->current_zone_ = zone;
-      this->current_channel_ = ch;
-      for (auto& p : this->numeric_sensors_) {
-        if (p.first == XRS_SENSOR_ZONE)
-          p.second->publish_state(this->current_zone_);
-        else if (p.first == XRS_SENSOR_CHANNEL)
-          p.second->publish_state(this->current_channel_);
-      }
-      this->publish_channel_label_();
+      this->on_zone_channel_report_(zone, ch);
     }
     return;
   }
@@ -1078,12 +2539,7 @@ void XRSRadioComponent::handle_line_(const std::string& line) {
   if (starts_with("+WHZS:")) {
     int zone = 0;
     if (sscanf(line.c_str(), "+WHZS: %d", &zone) == 1) {
-      this->current_zone_ = zone;
-      for (auto& p : this->numeric_sensors_) {
-        if (p.first == XRS_SENSOR_ZONE)
-          p.second->publish_state(this->current_zone_);
-      }
-      this->publish_channel_label_();
+      this->on_zone_channel_report_(zone, -1);
     }
     return;
   }
@@ -1150,75 +2606,284 @@ void XRSRadioComponent::handle_line_(const std::string& line) {
     return;
   }
 
+  if (!this->level_prefix_.empty() && starts_with(this->level_prefix_.c_str())) {
+    char* end = nullptr;
+    const long value =
+        std::strtol(line.c_str() + this->level_prefix_.size(), &end, 10);
+    if (end != line.c_str() + this->level_prefix_.size()) {
+      this->handle_level_notification_(static_cast<int>(value));
+    }
+    return;
+  }
+
   if (!line.empty() && line[0] == '+') {
-    for (auto& p : this->text_sensors_) {
-      if (p.first == XRS_TEXT_LAST_MESSAGE) p.second->publish_state(line);
+    XRSEvent* ev = this->record_event_(XRS_EVENT_UNKNOWN_LINE);
+    if (ev != nullptr) {
+      strncpy(ev->text, line.c_str(), XRSEvent::TEXT_MAX - 1);
+      ev->text[XRSEvent::TEXT_MAX - 1] = '\0';
     }
+    this->publish_text_(XRS_TEXT_LAST_MESSAGE, line);
   }
 }
 
 void XRSRadioComponent::spp_callback_static(esp_spp_cb_event_t event,
                                             esp_spp_cb_param_t* param) {
-  if (XRSRadioComponent::instance_ != nullptr)
-    XRSRadioComponent::instance_->on_spp_event_(event, param);
+  XRSRadioComponent* radio = nullptr;
+  switch (event) {
+    case ESP_SPP_INIT_EVT:
+      // Stack-wide: every radio may start connecting.
+      for (size_t i = 0; i < radio_count_; i++)
+        radios_[i]->on_spp_event_(event, param);
+      return;
+
+    case ESP_SPP_CL_INIT_EVT:
+      radio = connect_owner_.load();
+      if (radio != nullptr) radio->bt_handle_ = param->cl_init.handle;
+      break;
+
+    case ESP_SPP_OPEN_EVT:
+      for (size_t i = 0; i < radio_count_; i++) {
+        if (memcmp(radios_[i]->target_mac_, param->open.rem_bda,
+                   sizeof(esp_bd_addr_t)) == 0) {
+          radio = radios_[i];
+          break;
+        }
+      }
+      if (radio == nullptr) radio = connect_owner_.load();
+      if (radio != nullptr) radio->bt_handle_ = param->open.handle;
+      break;
+
+    case ESP_SPP_CLOSE_EVT:
+      radio = find_by_handle_(param->close.handle);
+      if (radio != nullptr) radio->bt_handle_ = 0;
+      break;
+
+    case ESP_SPP_DATA_IND_EVT:
+      radio = find_by_handle_(param->data_ind.handle);
+      break;
+
+    case ESP_SPP_CONG_EVT:
+      radio = find_by_handle_(param->cong.handle);
+      break;
+
+    case ESP_SPP_WRITE_EVT:
+      radio = find_by_handle_(param->write.handle);
+      break;
+
+    default:
+      ESP_LOGD(TAG, "Unhandled SPP event: %d", event);
+      return;
+  }
+  if (radio == nullptr) {
+    ESP_LOGD(TAG, "SPP event %d for no known radio", event);
+    return;
+  }
+  radio->on_spp_event_(event, param);
+}
+
+XRSRadioComponent* XRSRadioComponent::find_by_handle_(uint32_t handle) {
+  if (handle == 0) return nullptr;
+  for (size_t i = 0; i < radio_count_; i++) {
+    if (radios_[i]->bt_handle_ == handle) return radios_[i];
+  }
+  return nullptr;
 }
 
 void XRSRadioComponent::on_spp_event_(esp_spp_cb_event_t event,
                                       esp_spp_cb_param_t* param) {
+  // Runs in the Bluetooth task: record the event and let loop() act on it.
   switch (event) {
     case ESP_SPP_INIT_EVT: {
-      ESP_LOGI(TAG, "ESP_SPP_INIT_EVT");
-      this->spp_ready_ = true;
-      this->reconnect_delay_ms_ = 2000;
-      this->last_reconnect_attempt_ = 0;
+      LockGuard guard(this->event_lock_);
+      this->pending_init_ = true;
       break;
     }
 
     case ESP_SPP_OPEN_EVT: {
-      ESP_LOGI(TAG, "ESP_SPP_OPEN_EVT: connection opened");
-      this->connected_ = true;
-      this->connecting_ = false;
-      this->spp_handle_ = param->open.handle;
-      this->reconnect_delay_ms_ = 2000;
-      this->last_reconnect_attempt_ = 0;
-      this->publish_connection_state_();
-      this->send_handshake_commands_();
+      LockGuard guard(this->event_lock_);
+      this->pending_open_ = true;
+      this->pending_handle_ = param->open.handle;
+      break;
+    }
+
+    case ESP_SPP_CL_INIT_EVT: {
+      // Only a failed connect needs handling; success is followed by OPEN.
+      if (param->cl_init.status == ESP_SPP_SUCCESS) return;
+      LockGuard guard(this->event_lock_);
+      this->pending_close_ = true;
       break;
     }
 
     case ESP_SPP_CLOSE_EVT: {
-      ESP_LOGI(TAG, "ESP_SPP_CLOSE_EVT: connection closed");
-      this->connected_ = false;
-      this->connecting_ = false;
-      this->spp_handle_ = 0;
-      this->publish_connection_state_();
+      LockGuard guard(this->event_lock_);
+      this->pending_close_ = true;
+      this->pending_congested_ = false;
+      break;
+    }
+
+    case ESP_SPP_CONG_EVT: {
+      LockGuard guard(this->event_lock_);
+      this->pending_congested_ = param->cong.cong;
+      break;
+    }
+
+    case ESP_SPP_WRITE_EVT: {
+      LockGuard guard(this->event_lock_);
+      if (param->write.cong == this->pending_congested_) return;
+      this->pending_congested_ = param->write.cong;
       break;
     }
 
     case ESP_SPP_DATA_IND_EVT: {
-      const uint8_t* data = param->data_ind.data;
-      const uint16_t len = param->data_ind.len;
-      for (uint16_t i = 0; i < len; i++) {
-        char c = static_cast<char>(data[i]);
-        if (c == '\r') continue;
-        if (c == '\n') {
-          if (!this->rx_buffer_.empty()) {
-            std::string line = this->rx_buffer_;
-            this->rx_buffer_.clear();
-            this->handle_line_(line);
-          }
-        } else {
-          this->rx_buffer_.push_back(c);
-        }
+      LockGuard guard(this->event_lock_);
+      if (this->no_heap_ && this->rx_pending_.size() + param->data_ind.len >
+                                this->rx_pending_.capacity()) {
+        this->pending_rx_dropped_ += param->data_ind.len;
+        break;
       }
+      this->rx_pending_.append(reinterpret_cast<const char*>(param->data_ind.data),
+                               param->data_ind.len);
       break;
     }
 
     default:
       ESP_LOGD(TAG, "Unhandled SPP event: %d", event);
-      break;
+      return;
   }
+  this->enable_loop_soon_any_context();
+}
+
+void XRSRadioComponent::process_spp_events_() {
+  bool init;
+  bool open;
+  bool close;
+  uint32_t handle;
+  uint32_t rx_dropped;
+  {
+    LockGuard guard(this->event_lock_);
+    init = this->pending_init_;
+    open = this->pending_open_;
+    close = this->pending_close_;
+    handle = this->pending_handle_;
+    this->tx_congested_ = this->pending_congested_;
+    this->pending_init_ = false;
+    this->pending_open_ = false;
+    this->pending_close_ = false;
+    this->rx_work_.swap(this->rx_pending_);
+    rx_dropped = this->pending_rx_dropped_;
+    this->pending_rx_dropped_ = 0;
+  }
+
+  if (rx_dropped != 0) {
+    ESP_LOGW(TAG, "RX buffer full, dropped %" PRIu32 " bytes", rx_dropped);
+  }
+
+  if (init) {
+    ESP_LOGI(TAG, "ESP_SPP_INIT_EVT");
+    this->spp_ready_ = true;
+    this->reconnect_delay_ms_ = 2000;
+    this->last_reconnect_attempt_ = 0;
+    this->schedule_reconnect_();
+  }
+
+  if (open) {
+    ESP_LOGI(TAG, "ESP_SPP_OPEN_EVT: connection opened");
+    this->connected_ = true;
+    this->connecting_ = false;
+    this->spp_handle_ = handle;
+    this->release_connect_turn_();
+    if (++this->metrics_.connects > 1) this->metrics_.reconnects++;
+    this->reconnect_delay_ms_ = 2000;
+    this->last_reconnect_attempt_ = 0;
+    this->timers_.cancel(TIMER_RECONNECT);
+    if (this->location_mode_)
+      this->timers_.schedule(TIMER_LOCATION, esphome::millis(), 0);
+    this->location_gate_.reset();
+    this->framer_.reset();
+    this->record_event_(XRS_EVENT_CONNECTED);
+    this->publish_connection_state_();
+    this->send_handshake_commands_();
+  }
+
+  // Data queued before a close still belongs to the connection that just
+  // ended, so handle it before tearing down.
+  if (!this->rx_work_.empty()) {
+    this->handle_rx_bytes_(this->rx_work_);
+    this->rx_work_.clear();
+  }
+
+  if (close) {
+    ESP_LOGI(TAG, "ESP_SPP_CLOSE_EVT: connection closed");
+    this->connected_ = false;
+    this->connecting_ = false;
+    this->spp_handle_ = 0;
+    this->release_connect_turn_();
+    this->tx_count_ = 0;
+#ifdef USE_XRS_AT_BRIDGE
+    this->at_bridge_.on_link_closed();
+#endif
+    this->commands_.clear();
+    if (this->change_pending_) this->rollback_zone_channel_();
+    // A dump cut short by the disconnect must not count as complete.
+    this->channel_table_load_active_ = false;
+    this->timers_.cancel(TIMER_LOCATION);
+    this->timers_.cancel(TIMER_ACTIVE_MUTE);
+    this->cancel_timeout("handshake_step");
+    this->set_link_state_(XRS_LINK_DOWN);
+    // The first report after reconnecting is published as is.
+    this->level_.reset();
+    // Re-read on the next connect; flips not yet written are kept for it.
+    this->s109_known_ = false;
+    this->s109_read_pending_ = false;
+    this->cancel_timeout("s109_read");
+    this->record_event_(XRS_EVENT_DISCONNECTED);
+    this->publish_connection_state_();
+    this->schedule_reconnect_();
+  }
+}
+
+void XRSRadioComponent::handle_rx_bytes_(const std::string& data) {
+  this->metrics_.rx_bytes += data.size();
+  this->metrics_.last_rx_ms = esphome::millis();
+  this->metrics_.has_rx = true;
+  this->framer_.feed(data.data(), data.size(), [this](const std::string& line) {
+    this->metrics_.rx_lines++;
+    if (this->consume_echo_(line)) return;
+    const uint32_t started = esphome::micros();
+    this->handle_line_(line);
+    this->metrics_.parse_time_us.add(esphome::micros() - started);
+  });
+
+  if (this->framer_.resyncs() != this->rx_resyncs_seen_) {
+    ESP_LOGW(TAG, "Line without line end dropped at a new message (%" PRIu32
+             " resyncs)", this->framer_.resyncs());
+    this->rx_resyncs_seen_ = this->framer_.resyncs();
+  }
+  if (this->framer_.overflows() != this->rx_overflows_seen_) {
+    ESP_LOGW(TAG, "Line longer than %u bytes dropped (%" PRIu32 " overflows)",
+             static_cast<unsigned>(this->framer_.max_length()),
+             this->framer_.overflows());
+    this->rx_overflows_seen_ = this->framer_.overflows();
+  }
+}
+
+bool XRSRadioComponent::consume_echo_(const std::string& line) {
+  // Status lines from the radio may start with "AT" too (protocol.md 5.1),
+  // so only lines matching a command still in flight count as echoes.
+  if (!this->echo_ || line.size() < 2 || (line[0] != 'A' && line[0] != 'a'))
+    return false;
+  uint32_t latency = 0;
+  if (!this->commands_.on_echo(esphome::millis(), line.data(), line.size(),
+                               latency))
+    return false;
+  this->metrics_.echo_sum_ms += latency;
+  this->metrics_.echo_count++;
+  ESP_LOGV(TAG, "Echo: %s (%" PRIu32 " ms)", line.c_str(), latency);
+#ifdef USE_XRS_AT_BRIDGE
+  this->at_bridge_.on_line(line);
+#endif
+  return true;
 }
 
 }  // namespace xrs_radio
-}  // namespace esphome
\ No newline at end of file
+}  // namespace esphome
@@ -1,11 +1,15 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <cstring>
 #include <cmath>
 
+#include "esphome/core/automation.h"
 #include "esphome/core/component.h"
+#include "esphome/core/defines.h"
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
 
@@ -15,6 +19,22 @@
 #include "esphome/components/number/number.h"
 #include "esphome/components/switch/switch.h"
 #include "esphome/components/select/select.h"
+#ifdef USE_TIME
+#include "esphome/components/time/real_time_clock.h"
+#endif
+
+#include "airtime.h"
+#include "at_bridge.h"
+#include "event_log.h"
+#include "freq_index.h"
+#include "level.h"
+#include "line_framer.h"
+#include "line_matcher.h"
+#include "location.h"
+#include "metrics.h"
+#include "state_snapshot.h"
+#include "status_message.h"
+#include "timer_wheel.h"
 
 extern "C" {
 #include "esp_bt.h"
@@ -27,15 +47,25 @@ extern "C" {
 namespace esphome {
 namespace xrs_radio {
 
-// Numeric sensor types (channel, zone, volume, PTT timer)
+// Numeric sensor types (channel, zone, volume, PTT timer, per-channel airtime,
+// level)
 enum XRSNumericSensorType {
   XRS_SENSOR_CHANNEL = 0,
   XRS_SENSOR_ZONE = 1,
   XRS_SENSOR_VOLUME = 2,
   XRS_SENSOR_PTT_TIMER = 3,
+  XRS_SENSOR_AIRTIME_TRANSMISSIONS = 4,
+  XRS_SENSOR_AIRTIME_SECONDS = 5,
+  XRS_SENSOR_AIRTIME_DUTY_1M = 6,
+  XRS_SENSOR_AIRTIME_DUTY_15M = 7,
+  XRS_SENSOR_AIRTIME_DUTY_1H = 8,
+  // Periodic 0-100 level report, and the same quantised to 0/25/50/75/100.
+  XRS_SENSOR_LEVEL = 9,
+  XRS_SENSOR_LEVEL_COARSE = 10,
 };
 
-// Binary sensor types (connection, PTT, power, scan, duplex, memories, quiet mode)
+// Binary sensor types (connection, PTT, power, scan, duplex, memories, quiet
+// mode, ready)
 enum XRSBinarySensorType {
   XRS_BIN_CONNECTED = 0,
   XRS_BIN_PTT_ACTIVE = 1,
@@ -46,9 +76,12 @@ enum XRSBinarySensorType {
   XRS_BIN_SILENT_MEMORY = 6,
   XRS_BIN_QUIET_MEMORY = 7,
   XRS_BIN_QUIET_MODE = 8,
+  // Handshake finished: identified, channel table loaded.
+  XRS_BIN_READY = 9,
 };
 
-// Text sensor types (device info, last message, PTT/power state, channel label)
+// Text sensor types (device info, last message, PTT/power state, channel label,
+// busiest airtime channel, event history export chunks)
 enum XRSTextSensorType {
   XRS_TEXT_MANUFACTURER = 0,
   XRS_TEXT_MODEL = 1,
@@ -58,6 +91,15 @@ enum XRSTextSensorType {
   XRS_TEXT_POWER_STATE = 5,
   XRS_TEXT_PTT_STATE = 6,
   XRS_TEXT_CHANNEL_LABEL = 7,
+  XRS_TEXT_AIRTIME_CHANNEL = 8,
+  XRS_TEXT_EVENT_EXPORT = 9,
+  XRS_TEXT_TABLE_EXPORT = 10,
+};
+
+// Output formats for export_channel_table().
+enum XRSTableExportFormat : uint8_t {
+  XRS_TABLE_EXPORT_CSV = 0,
+  XRS_TABLE_EXPORT_JSON = 1,
 };
 
 // Number entities (writeable numeric controls)
@@ -73,12 +115,75 @@ enum XRSSwitchType {
   XRS_SWITCH_QUIET_MODE = 3,
   XRS_SWITCH_QUIET_MEMORY = 4,
   XRS_SWITCH_SILENT_MEMORY = 5,
+  // One bit of the ATS109 configuration register (see set_s109_bit).
+  XRS_SWITCH_S109_BIT = 6,
 };
 
 // Select entities for zone/channel control.
 enum XRSSelectType {
   XRS_SELECT_ZONE = 0,
   XRS_SELECT_CHANNEL = 1,
+  // Channels of the current zone only; options follow zone changes.
+  XRS_SELECT_ZONE_CHANNEL = 2,
+};
+
+// Internal runtime metrics, published through plain sensor::Sensor entities
+// configured in the hub's optional "metrics:" block.
+enum XRSMetricType {
+  XRS_METRIC_RX_BYTES_RATE = 0,
+  XRS_METRIC_LINES_RATE = 1,
+  XRS_METRIC_PARSE_TIME_P50 = 2,
+  XRS_METRIC_PARSE_TIME_P99 = 3,
+  XRS_METRIC_TX_QUEUE_DEPTH = 4,
+  XRS_METRIC_COMMAND_RTT = 5,
+  XRS_METRIC_PUBLISH_RATE = 6,
+  XRS_METRIC_RECONNECT_COUNT = 7,
+  XRS_METRIC_TIME_SINCE_LAST_RX = 8,
+  XRS_METRIC_CHANNEL_TABLE_HEAP = 9,
+  XRS_METRIC_ECHO_LATENCY = 10,
+  XRS_METRIC_TIME_TO_READY = 11,
+  // Lines lost to framing: cut short by a message-start marker, or longer
+  // than max_line_length.
+  XRS_METRIC_RX_RESYNCS = 12,
+  XRS_METRIC_RX_OVERFLOWS = 13,
+};
+
+// Connection bring-up, in order. A link drop goes back to DOWN.
+enum XRSLinkState : uint8_t {
+  XRS_LINK_DOWN = 0,
+  XRS_LINK_CONNECTING = 1,
+  XRS_LINK_IDENTIFY = 2,
+  XRS_LINK_TABLE = 3,
+  XRS_LINK_READY = 4,
+};
+
+// Consistent copy of a radio's state, from XRSRadioComponent::get_state().
+// zone/channel are what the hub shows (including a pending optimistic
+// change); radio_zone/radio_channel what the radio last confirmed.
+struct XRSRadioState {
+  uint32_t channel_table_hash;
+  uint32_t time_to_ready_ms;
+  int32_t ptt_timer;
+  uint8_t link_state;  // XRSLinkState
+  uint8_t zone;
+  uint8_t channel;
+  uint8_t radio_zone;
+  uint8_t radio_channel;
+  uint8_t volume;
+  uint8_t power_state;
+  uint8_t level;  // 0-100, valid if has_level
+  uint8_t level_coarse;
+  bool has_level;
+  bool connected;
+  bool change_pending;
+  bool ptt_active;
+  bool ptt_data;
+  bool power_low;
+  bool scanning;
+  bool duplex_enabled;
+  bool silent_memory;
+  bool quiet_memory;
+  bool quiet_mode;
 };
 
 class XRSRadioComponent;
@@ -100,9 +205,116 @@ class XRSRadioComponent : public Component {
   // Store external latitude/longitude sensors used for AT+WGTLOC payload.
   void set_location_sensors(sensor::Sensor *lat, sensor::Sensor *lon);
 
-  // Configure interval between automatic AT+WGTLOC commands (milliseconds).
+  // Configure the keep-alive interval for AT+WGTLOC while stationary (milliseconds).
   void set_location_interval(uint32_t interval_ms);
 
+  // Never upload locations more often than this (milliseconds).
+  void set_location_min_interval(uint32_t interval_ms);
+
+  // Upper bound for the stationary keep-alive back-off (milliseconds).
+  void set_location_max_interval(uint32_t interval_ms);
+
+  // Movement (metres) since the last upload that triggers a new one.
+  void set_location_min_distance(float metres);
+
+  // Heading change (degrees) since the last upload that triggers a new one.
+  void set_location_heading_change(float degrees);
+
+  // Fixes implying a speed above this (m/s) are rejected as GPS glitches.
+  void set_location_max_speed(float metres_per_second);
+
+  // Smoothing factor for incoming fixes (1.0 = unsmoothed).
+  void set_location_smoothing(float alpha);
+
+#ifdef USE_TIME
+  // Time source for the HHMMSS field of AT+WGTLOC (UTC).
+  void set_time(time::RealTimeClock *time) { this->time_ = time; }
+#endif
+
+  // Configure how often per-channel airtime sensors are published (milliseconds).
+  void set_airtime_update_interval(uint32_t interval_ms);
+
+  // Number of events kept in the history ring (0 disables the history).
+  void set_event_history_size(uint16_t size) { this->event_history_size_ = size; }
+
+  // Stream the most recent `max_events` history entries (0 = all held) to the
+  // log and any event_export text sensors, a few entries per loop iteration.
+  void export_events(uint16_t max_events);
+
+  // Stream the channel table as CSV or JSON to the log and any table_export
+  // text sensors, in chunks of at most TABLE_EXPORT_CHUNK_BYTES.
+  void export_channel_table(XRSTableExportFormat format);
+
+#ifdef USE_XRS_AT_BRIDGE
+  // Local AT-over-TCP bridge sharing this radio's SPP link.
+  void set_at_bridge_port(uint16_t port) {
+    this->at_bridge_.set_port(port);
+    this->at_bridge_enabled_ = true;
+  }
+  void set_at_bridge_max_clients(uint8_t clients) { this->at_bridge_.set_max_clients(clients); }
+  void set_at_bridge_buffer_size(uint16_t bytes) { this->at_bridge_.set_buffer_size(bytes); }
+#endif
+
+  // Bluetooth bring-up. The stack is shared, so these must match across
+  // radios (checked at config validation); the first radio to start it
+  // applies them.
+  // Run the controller in Classic-only mode instead of the sdkconfig default.
+  void set_bt_classic_only(bool classic_only) { this->bt_classic_only_ = classic_only; }
+  // Hand the BLE controller memory back to the heap (needs Classic-only).
+  void set_bt_release_ble_memory(bool release) { this->bt_release_ble_memory_ = release; }
+  // Start Bluetooth only once the network is connected, or after
+  // `timeout_ms` without it.
+  void set_bt_start_after_network(bool wait, uint32_t timeout_ms) {
+    this->bt_wait_network_ = wait;
+    this->bt_network_timeout_ms_ = timeout_ms;
+  }
+  // Further delay before starting Bluetooth (milliseconds).
+  void set_bt_start_delay(uint32_t delay_ms) { this->bt_start_delay_ms_ = delay_ms; }
+
+  // Longest line taken from the radio; longer ones are dropped whole.
+  void set_max_line_length(uint16_t bytes) { this->framer_.set_max_length(bytes); }
+
+  // No-heap mode: every buffer below is allocated once in setup() at these
+  // sizes and never grows; data that does not fit is dropped and logged.
+  void set_no_heap(bool no_heap) { this->no_heap_ = no_heap; }
+  // Each of the two SPP receive buffers (Bluetooth task -> loop()).
+  void set_rx_buffer_size(uint16_t bytes) { this->rx_buffer_size_ = bytes; }
+  void set_tx_queue_size(uint8_t commands) { this->tx_queue_max_ = commands; }
+  // Longest command accepted into the TX queue.
+  void set_max_command_length(uint16_t bytes) { this->max_command_length_ = bytes; }
+  // Rows (and so labels) the channel table can hold.
+  void set_channel_table_size(uint16_t rows) { this->channel_table_size_ = rows; }
+
+  // AT+WGTMSG status messages: "@<username>#<status>", where the status is
+  // the template's literal parts with the inputs' states in between.
+  void set_status_username(const std::string &username);
+  void set_status_template(std::vector<std::string> literals) {
+    this->status_message_.set_template(std::move(literals));
+  }
+  // At most `burst` messages back to back, then one per `interval_ms`.
+  void set_status_rate(uint32_t interval_ms, uint8_t burst) {
+    this->status_message_.set_rate(interval_ms, burst);
+  }
+  // Template inputs, in slot order.
+  void add_status_sensor(sensor::Sensor *s, int8_t accuracy_decimals);
+  void add_status_text_sensor(text_sensor::TextSensor *s);
+
+  // Active mute: while `call` is on, the radio is told a call is active
+  // (AT+WGACTM=0) and reminded every `interval_ms` (AT+WGACTM=2); when it
+  // goes off, mute is released (AT+WGACTM=1).
+  void set_active_mute_sensor(binary_sensor::BinarySensor *call) { this->call_sensor_ = call; }
+  void set_active_mute_interval(uint32_t interval_ms) { this->active_mute_interval_ms_ = interval_ms; }
+
+  // Handshake with ATE1 (default) or ATE0. With echo on, our own commands
+  // coming back are recognised in the framer and never reach handle_line_.
+  void set_echo(bool echo) { this->echo_ = echo; }
+
+  // Configure how often metric sensors are published (milliseconds).
+  void set_metrics_interval(uint32_t interval_ms);
+
+  // Register a runtime metric sensor (rates, latencies, queue depth etc.).
+  void register_metric_sensor(XRSMetricType type, sensor::Sensor *s);
+
   // Register a numeric sensor (channel, zone, volume, PTT timer).
   void register_numeric_sensor(XRSNumericSensorType type, XRSRadioSensor *s);
 
@@ -142,79 +354,225 @@ class XRSRadioComponent : public Component {
   // Enable/disable silent memory for current channel (AT+WGCSM=<0/1>).
   void set_silent_memory(bool enabled);
 
-  // Request a zone change from the radio (AT+WGZS=<zone>).
+  // Set or clear one bit of the ATS109 configuration register. The register
+  // is read once per connection (ATS109?) and cached; flips made within
+  // S109_BATCH_MS are merged into a single ATS109=<value> write on top of
+  // the cached value, and held back until the cached value is known.
+  void set_s109_bit(uint8_t bit, bool state);
+
+  // Line prefix of the radio's 0-100 level report, e.g. "+WGLEVEL:".
+  void set_level_prefix(const std::string &prefix) { this->level_prefix_ = prefix; }
+  // Points the level must move before it, or the coarse level, is republished.
+  void set_level_hysteresis(uint8_t points) { this->level_.set_hysteresis(points); }
+
+  // Request a zone change from the radio (AT+WGZS=<zone>). Applied
+  // optimistically and rolled back if the radio does not confirm it.
   void set_target_zone(uint8_t zone);
 
   // Request a zone+channel change from the radio (AT+WGCHS=<zone>,<channel>).
+  // Applied optimistically and rolled back if the radio does not confirm it.
   void set_target_zone_channel(uint8_t zone, uint8_t channel);
 
+  // How long to wait for +WGCHS:/+WHZS: before rolling a change back (ms).
+  void set_change_timeout(uint32_t timeout_ms) { this->change_timeout_ms_ = timeout_ms; }
+
+  // Snapshot of the radio state, safe to call from any task and cheap
+  // enough for lambdas; zone and channel always belong together.
+  XRSRadioState get_state() const { return this->state_.read(); }
+  // Changes whenever get_state() would return something new.
+  uint32_t get_state_version() const { return this->state_.version(); }
+
   // Get the current zone/channel for select initial state.
   uint8_t get_current_zone() const { return static_cast<uint8_t>(current_zone_); }
   uint8_t get_current_channel() const { return static_cast<uint8_t>(current_channel_); }
 
-  // Fill out available zone options, e.g. ["Zone 1", "Zone 2", ...].
-  void get_zone_options(std::vector<std::string> &out) const;
+  // Prebuilt options for a select: ["Zone 1", ...] or ["Z1 / Ch 40: CH40", ...].
+  const std::vector<std::string> &get_options(XRSSelectType type) const;
+
+  // Bumped whenever the option list for `type` is rebuilt.
+  uint32_t get_options_version(XRSSelectType type) const {
+    return this->options_version_[type];
+  }
 
-  // Fill out channel options, e.g. ["Z1 / Ch 40: CH40", ...].
-  void get_channel_options(std::vector<std::string> &out) const;
+  // Map an option index back to its zone/channel (channel is 0 for zone options).
+  bool get_option_zone_channel(XRSSelectType type, size_t index, uint8_t &zone,
+                               uint8_t &channel) const;
 
-  /// Set the current zone on the radio and cache state
+  // Index of the option for the current zone/channel, or -1 if none.
+  int get_current_option_index(XRSSelectType type) const;
+
+  /// Set the current zone on the radio (same pipeline as set_target_zone)
   void set_zone(uint8_t zone);
 
-  /// Set the current zone + channel on the radio and cache state
+  /// Set the current zone + channel on the radio (same pipeline as set_target_zone_channel)
   void set_channel(uint8_t zone, uint8_t channel);
 
   // Request a full channel/squelch table from the radio (AT_WGCHSQ).
   void request_channel_table();
 
+  // Order-independent content hash of the channel table (0 when empty).
+  uint32_t get_channel_table_hash() const { return this->channel_table_hash_; }
+
+  // Called with the new table hash when a table load actually changed rows.
+  void add_on_channel_table_change_callback(std::function<void(uint32_t)> &&callback) {
+    this->channel_table_change_callback_.add(std::move(callback));
+  }
+
+  // Compiled on_line: patterns (see LineMatcher), emitted by the codegen.
+  void set_line_patterns(const LineMatcher::Node *nodes, const uint16_t *terms,
+                         const LineMatcher::Pattern *patterns, uint16_t count);
+
+  // on_line: trigger for pattern `index`, fired with the line and its fields.
+  void register_line_trigger(uint16_t index,
+                             Trigger<std::string, std::vector<std::string>> *trigger);
+
+  // RX/TX frequency index over the channel table, rebuilt once per table load.
+  const FrequencyIndex &get_frequency_index() const { return this->frequency_index_; }
+
+  // Tune to the channel whose RX or TX frequency (MHz) is closest to `mhz`,
+  // within `tolerance_mhz`, via AT+WGCHS.
+  void tune_to_frequency(float mhz, XRSFrequencyBand band, float tolerance_mhz);
+
+  // Where the connection bring-up is; READY once the radio is usable.
+  XRSLinkState get_link_state() const { return this->link_state_; }
+
   // Standard ESPHome lifecycle: initialize BT/SPP and start connection attempts.
   void setup() override;
 
-  // Standard ESPHome lifecycle: handle reconnect backoff and location tick.
+  // Standard ESPHome lifecycle: drain SPP events, run due reconnect/location
+  // work, then disable the loop until the next deadline or SPP event.
   void loop() override;
 
   // Standard ESPHome lifecycle: dump configuration and current state to the log.
   void dump_config() override;
 
  protected:
+  static constexpr size_t MAX_LABEL_LENGTH = 32;
+
   // Single channel entry from the radio’s channel/squelch table.
   struct ChannelInfo {
     uint8_t zone;
     uint8_t channel;
     float rx_freq;
     float tx_freq;
-    std::string label;
+    // Fixed-size so rows own no heap memory; longer labels are truncated.
+    char label[MAX_LABEL_LENGTH + 1];
+    // Content hash of this row, and the table load that last reported it.
+    uint32_t hash;
+    uint32_t load_gen;
   };
 
+  // A +WGCHSQ: dump is complete at the final result of AT_WGCHSQ. Should
+  // that result be lost, the dump is ended once no row has arrived for
+  // this long.
+  static constexpr uint32_t CHANNEL_TABLE_FALLBACK_MS = 5000;
+  static constexpr const char *CHANNEL_TABLE_QUERY = "AT_WGCHSQ";
+
   esp_bd_addr_t target_mac_{};
 
-  // Initialize ESP32 Bluetooth Classic controller and SPP stack.
+  // Call init_bluetooth_() now, or once the configured network wait and
+  // start delay have passed.
+  void schedule_bluetooth_start_();
+  void start_bluetooth_after_delay_();
+
+  // Initialize ESP32 Bluetooth Classic controller and SPP stack (once per
+  // node, shared by all radios).
   void init_bluetooth_();
 
   // Start SPP connection to the configured MAC address.
   void start_connection_();
 
+  // Whether this radio may start a connect now. Only one esp_spp_connect()
+  // is in flight per node, and waiting radios get their turn in FIFO order.
+  bool may_start_connection_(uint32_t now);
+
+  // This radio's connect attempt ended (opened, closed or timed out): let
+  // the next waiting radio have its turn.
+  void release_connect_turn_();
+
   // Close current SPP connection if any.
   void close_connection_();
 
   // Handle a complete AT/notification line received from the radio.
   void handle_line_(const std::string &line);
 
-  // Send an AT command line terminated with CRLF over SPP.
-  void send_command_(const std::string &cmd);
+  // Queue an AT command line; loop() writes it terminated with CRLF.
+  // `owner` is an AT bridge client slot, or TX_OWNER_HUB for our own. The
+  // command is copied straight into a preallocated queue slot. Returns
+  // whether it was queued.
+  bool send_command_(const char *cmd, size_t len, uint8_t owner = TX_OWNER_HUB);
+  bool send_command_(const char *cmd) { return this->send_command_(cmd, strlen(cmd)); }
+
+  // Claim the next TX queue slot for a `len`-byte command and return its
+  // cleared line for the caller to fill, or nullptr (logged, quoting `cmd`)
+  // if the command cannot be queued. commit_tx_slot_() then queues it.
+  std::string *claim_tx_slot_(const char *cmd, size_t cmd_len, size_t len, uint8_t owner);
+  void commit_tx_slot_(std::string *line);
+
+  // Write up to TX_BURST queued commands to SPP, unless congested.
+  void drain_tx_queue_();
 
-  // Send initial identification and setup commands after SPP connect.
+  // Start the handshake after SPP connect: setup commands plus every
+  // identification query whose answer is not cached, all pipelined.
   void send_handshake_commands_();
 
-  // Build and send AT+WGTLOC=<time>,<lat>,<lon> using configured location sensors.
-  void send_location_update_();
+  // An identification answer (IDENT_* bit) arrived; moves on to the table
+  // step once none is outstanding.
+  void on_identity_reply_(uint8_t bit);
+
+  // Table step: load the channel table, waiting for it only if none is
+  // cached from an earlier connection.
+  void start_table_step_();
+
+  // Enter a bring-up state; publishes ready and time-to-ready.
+  void set_link_state_(XRSLinkState state);
+
+  // Combine the latest latitude/longitude sensor states into one fix and
+  // feed it to location_filter_. Deferred from the sensor callbacks so a
+  // lat+lon pair published in the same tick is processed once.
+  void on_location_sensor_update_();
+
+  // Build and send AT+WGTLOC=<HHMMSS>,<lat>,<lon> for the given fix.
+  void send_location_update_(double lat, double lon);
+
+  // Send the status message if it changed since the last one and the rate
+  // limit allows; otherwise retry when the next token is due.
+  void send_status_message_();
+
+  // Format an input's state into its template slot and, if that changed
+  // the text, schedule a send.
+  void on_status_input_(size_t index, const std::string &text);
 
   // Publish all current state values to registered sensors/entities.
   void publish_all_state_();
 
+  // Refresh state_ from the members below. Runs before every publish, so
+  // callbacks of the published entities already see the new state.
+  void update_state_snapshot_();
+
   // Publish connection state to any registered "connected" binary sensors.
   void publish_connection_state_();
 
+  // Publish a value to every registered entity of the given type.
+  void publish_numeric_(XRSNumericSensorType type, float value);
+  void publish_binary_(XRSBinarySensorType type, bool value);
+  void publish_text_(XRSTextSensorType type, const std::string &value);
+  // Skips entities already showing `value` (unless `always`), and publishes
+  // through text_scratch_ so no temporary string is built.
+  void publish_text_(XRSTextSensorType type, const char *value, bool always = false);
+  void publish_number_(XRSNumberType type, float value);
+  void publish_switch_(XRSSwitchType type, bool value);
+
+  // Human-readable text for the current PTT / power state.
+  const char *ptt_state_text_() const;
+  const char *power_state_text_() const;
+
+  // Compute rates/percentiles since the last call and publish metric sensors.
+  void publish_metrics_();
+
+  // Approximate heap bytes held by channel_table_ (entries + label storage).
+  size_t channel_table_heap_bytes_() const;
+
   // Parse and handle +WGPTT notification from the radio.
   void handle_ptt_notification_(int state, int timer);
 
@@ -236,34 +594,255 @@ class XRSRadioComponent : public Component {
   // Parse and handle +WGSSQ notification from the radio.
   void handle_quiet_mode_notification_(int enabled);
 
+  // Parse a level report and publish the level sensors that changed.
+  void handle_level_notification_(int value);
+
   // Parse a +WGCHSQ: ... line and update internal channel table.
   void handle_channel_table_line_(const std::string &line);
 
+  // Read ATS109 into the cache (once per connection, if any bit switches).
+  void request_s109_();
+
+  // Handle a line while an ATS109? read is outstanding; true if it was the
+  // register value.
+  bool handle_s109_line_(const std::string &line);
+
+  // Write the batched bit flips as one ATS109=<value>.
+  void flush_s109_();
+
+  // Publish the cached register to the bit switches.
+  void publish_s109_switches_();
+
   // Publish a label for the current zone/channel to XRS_TEXT_CHANNEL_LABEL sensors.
   void publish_channel_label_();
 
+  // Start an optimistic zone (channel == 0) or zone+channel change: apply it
+  // locally, send the AT command and arm the confirmation deadline.
+  void request_zone_channel_(uint8_t zone, uint8_t channel);
+
+  // Set current_zone_/current_channel_ and publish sensors, label and selects.
+  void apply_zone_channel_(int zone, int channel);
+
+  // Handle a zone/channel report from the radio (channel < 0: zone only).
+  void on_zone_channel_report_(int zone, int channel);
+
+  // Revert to the radio-confirmed zone/channel after a change timed out.
+  void rollback_zone_channel_();
+
+  // Format a zone/channel and its `label` as "Z1 / Ch 40: LABEL" (label
+  // omitted if empty) into `out`, reusing its capacity.
+  void format_channel_(uint8_t zone, uint8_t channel, const char *label, std::string &out) const;
+
+  // Append an event to the history ring; nullptr if the history is disabled.
+  XRSEvent *record_event_(XRSEventType type);
+
+  // Emit the next chunk of an export started by export_events().
+  void export_events_chunk_();
+
+  // Emit the next chunk of an export started by export_channel_table().
+  void export_table_chunk_();
+
+  // Format one channel table row as a CSV line or JSON object (preceded by
+  // a comma unless `first`). Returns the length written.
+  size_t format_table_row_(const ChannelInfo &row, bool first, char *buf, size_t len) const;
+
+  // Publish the busiest-channel airtime sensors from airtime_.
+  void publish_airtime_();
+
+  // Size the TX ring and, in no-heap mode, reserve every buffer up front.
+  void allocate_buffers_();
+
+  // Steady-state allocation check (no_heap: check_allocations). Arms the
+  // heap guard if the link is in the steady state; check_heap_() then marks
+  // the hub failed if the armed work allocated.
+  bool arm_heap_check_();
+  void check_heap_(bool armed);
+  // Run a scheduler callback under the same check as loop().
+  void run_checked_(void (XRSRadioComponent::*fn)());
+
+  // Rebuild the select option lists and their index tables from channel_table_.
+  void rebuild_options_();
+
+  // FNV-1a hash over a row's zone, channel, frequencies and label.
+  static uint32_t channel_row_hash_(const ChannelInfo &info);
+
+  // End of a table dump: drop rows the radio no longer reports and, if
+  // anything changed, rebuild derived state and fire the change event.
+  void finish_channel_table_load_();
+  // The AT_WGCHSQ dump ended (`ok` = with a final OK): finish the load and
+  // complete the handshake's table step.
+  void end_channel_table_load_(bool ok);
+
+  // Rebuild frequency_index_ from channel_table_.
+  void rebuild_frequency_index_();
+
+  // Rebuild the zone-scoped channel options for current_zone_.
+  void rebuild_zone_channel_options_();
+
+  // Whether a select of the given type is registered.
+  bool has_select_(XRSSelectType type) const;
+
   // Find label for given zone/channel in channel_table_ (empty if unknown).
-  std::string get_channel_label_(uint8_t zone, uint8_t channel) const;
+  const char *get_channel_label_(uint8_t zone, uint8_t channel) const;
 
-  // ESP-IDF SPP callback static entry, forwarding events to instance_.
+  // ESP-IDF SPP callback static entry: routes each event to the radio it
+  // belongs to (by SPP handle, peer address or pending connect).
   static void spp_callback_static(esp_spp_cb_event_t event, esp_spp_cb_param_t *param);
 
-  // ESP-IDF SPP callback implementation on the active instance.
+  // Radio owning an SPP handle, or nullptr. Bluetooth task only.
+  static XRSRadioComponent *find_by_handle_(uint32_t handle);
+
+  // ESP-IDF SPP callback implementation on the routed instance. Runs in the
+  // Bluetooth task: it only queues events and wakes loop().
   void on_spp_event_(esp_spp_cb_event_t event, esp_spp_cb_param_t *param);
 
+  // Apply SPP events queued by on_spp_event_ on the main loop.
+  void process_spp_events_();
+
+  // Split received bytes into lines and dispatch them to handle_line_.
+  void handle_rx_bytes_(const std::string &data);
+
+  // Whether `line` is the echo of a command we sent; records its latency.
+  bool consume_echo_(const std::string &line);
+
+  // Milliseconds from `now` until loop() next has timed work to do, or
+  // UINT32_MAX if it only needs to wake for SPP events.
+  uint32_t next_deadline_ms_(uint32_t now) const;
+
+  // Jobs on timers_, by timer id.
+  enum TimerId : uint8_t {
+    TIMER_RECONNECT = 0,
+    TIMER_LOCATION = 1,
+    TIMER_ACTIVE_MUTE = 2,
+  };
+
+  // Run the job for a timer that came due in loop().
+  void on_timer_(uint8_t id, uint32_t now);
+
+  // Arm TIMER_RECONNECT for when the backoff since the last attempt ends,
+  // if this radio is idle and able to connect.
+  void schedule_reconnect_();
+
+  // Upload the filtered location if the gate allows, then re-arm
+  // TIMER_LOCATION.
+  void check_location_(uint32_t now);
+
+  // Call state changed (active mute input), or the link came up.
+  void on_call_state_(bool active);
+  void send_active_mute_(uint8_t mode);
+
   // Convert "AA:BB:CC:DD:EE:FF" into esp_bd_addr_t (6 bytes).
   bool parse_mac_address_(esp_bd_addr_t out);
 
-  static XRSRadioComponent *instance_;
+  // Every radio on this node, registered by the constructor (before any
+  // Bluetooth activity) so the SPP callback can route without locking.
+  static constexpr size_t MAX_RADIOS = 4;
+  static XRSRadioComponent *radios_[MAX_RADIOS];
+  static size_t radio_count_;
+  // Controller, Bluedroid and SPP are brought up once for all radios.
+  static bool bt_stack_initialized_;
+  // How that went: millis() when it finished, how long it took, internal
+  // free heap before and after, and what releasing BLE memory gave back.
+  static uint32_t bt_started_at_;
+  static uint32_t bt_init_ms_;
+  static size_t bt_heap_before_;
+  static size_t bt_heap_after_;
+  static size_t bt_ble_released_;
+  static constexpr uint32_t BT_START_POLL_MS = 500;
+  // Radio with an esp_spp_connect() in flight. SPP only reveals the handle
+  // of an outgoing connection in ESP_SPP_CL_INIT_EVT, so connects are
+  // serialised across radios and CL_INIT is routed here.
+  static std::atomic<XRSRadioComponent *> connect_owner_;
+  static constexpr uint32_t CONNECT_TIMEOUT_MS = 20000;
 
   std::string mac_address_;
   bool bt_initialized_{false};
+  bool bt_classic_only_{false};
+  bool bt_release_ble_memory_{false};
+  bool bt_wait_network_{false};
+  uint32_t bt_network_timeout_ms_{60000};
+  uint32_t bt_start_delay_ms_{0};
   bool spp_ready_{false};
   bool connected_{false};
   bool connecting_{false};
   uint32_t spp_handle_{0};
-
-  std::string rx_buffer_;
+  // SPP handle as seen by the Bluetooth task, used only for routing there.
+  uint32_t bt_handle_{0};
+  // When this radio started waiting for its connect turn (0 = not waiting).
+  uint32_t connect_waiting_since_{0};
+
+  // Commands waiting to be written. Each radio writes at most TX_BURST per
+  // loop() pass, so several radios share the Bluetooth link fairly.
+  struct TxItem {
+    std::string line;
+    uint8_t owner;
+  };
+  // Ring of tx_queue_max_ slots, allocated in setup(); each slot's line
+  // keeps its capacity between commands.
+  std::vector<TxItem> tx_queue_;
+  size_t tx_head_{0};
+  size_t tx_count_{0};
+  size_t tx_queue_max_{16};
+  bool tx_congested_{false};
+  static constexpr uint8_t TX_OWNER_HUB = 0xFF;
+  static constexpr size_t TX_BURST = 2;
+
+#ifdef USE_XRS_AT_BRIDGE
+  // Accept a command from an AT bridge client; false if the TX queue is full.
+  bool submit_bridge_command_(uint8_t owner, const std::string &line);
+
+  ATBridge at_bridge_;
+  bool at_bridge_enabled_{false};
+  static constexpr uint32_t AT_BRIDGE_POLL_MS = 20;
+#endif
+
+  LineFramer framer_;
+  // Framer counters already logged.
+  uint32_t rx_resyncs_seen_{0};
+  uint32_t rx_overflows_seen_{0};
+  bool echo_{true};
+
+  // No-heap mode sizes (see set_no_heap()).
+  bool no_heap_{false};
+  uint16_t rx_buffer_size_{1024};
+  uint16_t max_command_length_{128};
+  uint16_t channel_table_size_{256};
+  // Scratch for published text (labels, states, export chunks), reused by
+  // every publish.
+  std::string text_scratch_;
+  // Steady-state allocations already reported.
+  uint32_t heap_allocs_seen_{0};
+
+  // SPP events handed from the Bluetooth task to loop(), guarded by event_lock_.
+  Mutex event_lock_;
+  bool pending_init_{false};
+  bool pending_open_{false};
+  bool pending_close_{false};
+  uint32_t pending_handle_{0};
+  // Latest SPP congestion state reported for this radio's connection.
+  bool pending_congested_{false};
+  std::string rx_pending_;
+  // Swapped with rx_pending_ when draining so both keep their capacity.
+  std::string rx_work_;
+  // Bytes that did not fit rx_pending_ in no-heap mode.
+  uint32_t pending_rx_dropped_{0};
+
+  // Deadlines for reconnect attempts, location checks and keep-alives;
+  // loop() sleeps until the earliest one.
+  TimerWheel timers_;
+
+  // Connection bring-up state and its timing.
+  static constexpr uint8_t IDENT_GMI = 1 << 0;
+  static constexpr uint8_t IDENT_GMM = 1 << 1;
+  static constexpr uint8_t IDENT_GMR = 1 << 2;
+  static constexpr uint8_t IDENT_GSN = 1 << 3;
+  static constexpr uint32_t IDENTIFY_TIMEOUT_MS = 3000;
+  static constexpr uint32_t TABLE_TIMEOUT_MS = 10000;
+  XRSLinkState link_state_{XRS_LINK_DOWN};
+  uint8_t identity_awaiting_{0};
+  uint32_t connect_started_at_{0};
+  uint32_t link_state_since_{0};
+  uint32_t time_to_ready_ms_{0};
 
   // Reconnect/backoff state.
   uint32_t reconnect_delay_ms_{2000};
@@ -281,6 +860,21 @@ class XRSRadioComponent : public Component {
   int current_zone_{0};
   int current_volume_{0};
 
+  // Last zone/channel the radio itself reported; current_* may run ahead of
+  // these while an optimistic change is pending.
+  int radio_zone_{0};
+  int radio_channel_{0};
+
+  // Optimistic zone/channel change awaiting confirmation (channel 0 = zone only).
+  bool change_pending_{false};
+  uint8_t pending_zone_{0};
+  uint8_t pending_channel_{0};
+  uint32_t change_timeout_ms_{3000};
+
+  // Level reports and their quantised state.
+  std::string level_prefix_{"+WGLEVEL:"};
+  LevelTracker level_;
+
   // Extended state from notifications.
   bool ptt_active_{false};
   bool ptt_data_{false};
@@ -293,6 +887,9 @@ class XRSRadioComponent : public Component {
   bool quiet_memory_{false};
   bool quiet_mode_{false};
 
+  // Published copy of the state above for get_state().
+  StateSnapshot<XRSRadioState> state_;
+
   // Registered sensors/entities.
   std::vector<std::pair<XRSNumericSensorType, XRSRadioSensor *>> numeric_sensors_;
   std::vector<std::pair<XRSBinarySensorType, XRSRadioBinarySensor *>> binary_sensors_;
@@ -300,16 +897,125 @@ class XRSRadioComponent : public Component {
   std::vector<std::pair<XRSNumberType, XRSRadioNumber *>> numbers_;
   std::vector<std::pair<XRSSwitchType, XRSRadioSwitch *>> switches_;
   std::vector<std::pair<XRSSelectType, XRSRadioSelect *>> selects_;
+  std::vector<std::pair<XRSMetricType, sensor::Sensor *>> metric_sensors_;
+
+  // Per-channel PTT airtime accounting.
+  AirtimeTracker airtime_;
+  uint32_t airtime_update_interval_ms_{60000};
+  bool has_airtime_entities_{false};
+
+  // Bounded history of radio events and the state of an ongoing export.
+  EventLog event_log_;
+  uint16_t event_history_size_{64};
+  bool export_active_{false};
+  uint32_t export_next_seq_{0};
+  uint32_t export_end_seq_{0};
+  uint32_t ptt_started_at_{0};
+  static constexpr size_t EXPORT_CHUNK_EVENTS = 4;
+  static constexpr size_t EXPORT_EVENT_BYTES = 96;
+  static constexpr uint32_t EXPORT_CHUNK_DELAY_MS = 20;
+  // One chunk: EXPORT_CHUNK_EVENTS formatted events, one per line.
+  char export_buf_[EXPORT_CHUNK_EVENTS * EXPORT_EVENT_BYTES];
+
+  // Channel table export: walks channel_table_ by index, packing rows into
+  // a fixed scratch buffer. Aborted if the table changes underneath it.
+  static constexpr size_t TABLE_EXPORT_CHUNK_BYTES = 256;
+  bool table_export_active_{false};
+  XRSTableExportFormat table_export_format_{XRS_TABLE_EXPORT_CSV};
+  size_t table_export_next_{0};
+  uint32_t table_export_hash_{0};
+  char table_export_buf_[TABLE_EXPORT_CHUNK_BYTES];
+
+  // Cached ATS109 register and bit flips waiting to be written.
+  static constexpr uint32_t S109_BATCH_MS = 100;
+  static constexpr uint32_t S109_READ_TIMEOUT_MS = 3000;
+  bool has_s109_switches_{false};
+  bool s109_known_{false};
+  bool s109_read_pending_{false};
+  uint32_t s109_value_{0};
+  uint32_t s109_set_mask_{0};
+  uint32_t s109_clear_mask_{0};
+
+  // Active mute input and what the radio was last told.
+  binary_sensor::BinarySensor *call_sensor_{nullptr};
+  uint32_t active_mute_interval_ms_{5000};
+  bool call_active_{false};
+  bool active_mute_engaged_{false};
+
+  // Status message template, its inputs and rate limit.
+  struct StatusInput {
+    sensor::Sensor *sensor;
+    text_sensor::TextSensor *text_sensor;
+    int8_t accuracy_decimals;
+  };
+  StatusMessage status_message_;
+  std::vector<StatusInput> status_inputs_;
+  bool status_enabled_{false};
+  // Retry delay when the TX queue had no room for the status message.
+  static constexpr uint32_t STATUS_MESSAGE_RETRY_MS = 1000;
+
+  // Runtime metrics and the counter snapshot taken at the last publish.
+  XRSMetrics metrics_;
+  CommandTracker commands_;
+  uint32_t metrics_interval_ms_{60000};
+  uint32_t last_metrics_publish_{0};
+  uint32_t last_rx_bytes_{0};
+  uint32_t last_rx_lines_{0};
+  uint32_t last_publishes_{0};
 
   // Location upload configuration/state.
   sensor::Sensor *latitude_sensor_{nullptr};
   sensor::Sensor *longitude_sensor_{nullptr};
   bool location_mode_{false};
   uint32_t location_interval_ms_{60000};
-  uint32_t last_location_sent_{0};
+  uint32_t location_min_interval_ms_{30000};
+  uint32_t location_max_interval_ms_{600000};
+  LocationFilter location_filter_;
+  LocationGate location_gate_;
+#ifdef USE_TIME
+  time::RealTimeClock *time_{nullptr};
+#endif
+  static constexpr uint32_t LOCATION_RETRY_MS = 1000;
 
   // Channel table from radio.
   std::vector<ChannelInfo> channel_table_;
+  // Sum of row hashes, kept up to date as rows are added/changed/removed.
+  uint32_t channel_table_hash_{0};
+  // Incremented by request_channel_table(); rows not seen in the current
+  // load are removed when it finishes.
+  uint32_t channel_table_load_gen_{0};
+  bool channel_table_load_active_{false};
+  uint16_t channel_table_rows_seen_{0};
+  uint16_t channel_table_added_{0};
+  uint16_t channel_table_changed_{0};
+  uint16_t channel_table_removed_{0};
+  CallbackManager<void(uint32_t)> channel_table_change_callback_;
+  FrequencyIndex frequency_index_;
+
+  // on_line: automations, indexed like the patterns in line_matcher_.
+  LineMatcher line_matcher_;
+  std::vector<Trigger<std::string, std::vector<std::string>> *> line_triggers_;
+
+  // Select options with a parallel key array (zone << 8 | channel) so an
+  // option index resolves to a zone/channel without parsing its text, plus
+  // reverse tables from zone/channel to option index, covering every
+  // channel number.
+  static constexpr uint8_t MAX_ZONES = 8;
+  // Channels offered per zone before a channel table is loaded.
+  static constexpr uint8_t DEFAULT_CHANNELS = 80;
+  static constexpr uint16_t NO_OPTION = 0xFFFF;
+  std::vector<std::string> zone_options_;
+  std::vector<uint8_t> zone_option_keys_;
+  std::vector<std::string> channel_options_;
+  std::vector<uint16_t> channel_option_keys_;
+  uint16_t zone_option_index_[MAX_ZONES]{};
+  uint16_t channel_option_index_[MAX_ZONES][256]{};
+  // Zone-scoped channel options, only built for zone_channel_options_zone_.
+  std::vector<std::string> zone_channel_options_;
+  std::vector<uint8_t> zone_channel_option_keys_;
+  uint16_t zone_channel_option_index_[256]{};
+  int zone_channel_options_zone_{-1};
+  uint32_t options_version_[3]{};
 };
 
 }  // namespace xrs_radio